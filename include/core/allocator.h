@@ -6,9 +6,27 @@
 #endif
 #include <cstddef>
 #include <map>
+#include <set>
 #include <unordered_set>
 
 namespace infini {
+  // Policy used to pick a free block for a new allocation.
+  enum class AllocPolicy
+  {
+    FirstFit, // lowest-offset free block that is large enough, O(#free blocks)
+    BestFit,  // smallest free block that is large enough, O(log #free blocks)
+  };
+
+  struct AllocatorStats
+  {
+    size_t used;             // bytes held by live blocks
+    size_t peak;             // arena size
+    size_t freeBlockCount;   // number of free blocks below peak
+    size_t largestFreeBlock; // bytes of the largest free block
+    // 1 - largestFreeBlock / free bytes, 0 means all free memory is one block
+    double fragmentation;
+  };
+
   class Allocator
   {
   private:
@@ -21,7 +39,9 @@ namespace infini {
     size_t alignment;
 
     // pointer to the memory actually allocated
-    void *ptr;  // 预分配时,该指针必须为nullptr,预分配的地址偏移都是相对于ptr的
+    void *ptr;  // 预分配的地址偏移都是相对于ptr的
+
+    size_t capacity;  // ptr 实际指向的内存大小(bytes)，重新规划时若 peak 不超过它则复用
 
     // =================================== 作业 ===================================
     // TODO：可能需要设计一个数据结构来存储free block，以便于管理和合并
@@ -29,8 +49,14 @@ namespace infini {
     // =================================== 作业 ===================================
     std::map<size_t, size_t> freeBlocks; // 用于记录预分配的空闲内存块，key为块的起始地址偏移，value为块的大小(bytes)
 
+    // 按大小索引的空闲块，元素为 (size, offset)，与 freeBlocks 始终保持一致
+    std::set<std::pair<size_t, size_t>> freeBlocksBySize;
+
+    AllocPolicy policy;
+
   public:
-    Allocator(Runtime runtime);
+    Allocator(Runtime runtime, AllocPolicy policy = AllocPolicy::BestFit,
+              size_t alignment = DEFAULT_ALIGNMENT);
 
     virtual ~Allocator();
 
@@ -46,15 +72,41 @@ namespace infini {
     //     size: size of memory block to be freed
     void free(size_t addr, size_t size);
 
-    // function: perform actual memory allocation
+    // function: perform actual memory allocation. The memory is reused
+    //           across plans and only reallocated when peak exceeds it, in
+    //           which case previously returned pointers become invalid
     // return: pointer to the head address of the allocated memory
     void *getPtr();
 
+    // function: discard the current plan so that a new one can be simulated,
+    //           the memory obtained by getPtr is kept
+    void reset();
+
     void info();
 
-  private:
+    AllocatorStats getStats() const;
+
+    void setPolicy(AllocPolicy policy);
+    AllocPolicy getPolicy() const { return policy; }
+
+    // function: set the alignment of every block, a power of two
+    void setAlignment(size_t alignment);
+    size_t getAlignment() const { return alignment; }
+
+    size_t getUsed() const { return used; }
+    size_t getPeak() const { return peak; }
+    size_t getCapacity() const { return capacity; }
+
     // function: memory alignment, rouned up
     // return: size of the aligned memory block
     size_t getAlignedSize(size_t size);
+
+  private:
+    // function: find a free block of at least `size` bytes following `policy`
+    // return: iterator into freeBlocks, or freeBlocks.end() if none fits
+    std::map<size_t, size_t>::iterator findFreeBlock(size_t size);
+
+    void insertFreeBlock(size_t addr, size_t size);
+    void eraseFreeBlock(std::map<size_t, size_t>::iterator it);
   };
 }
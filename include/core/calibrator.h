@@ -0,0 +1,33 @@
+#pragma once
+#include "core/common.h"
+#include "core/graph.h"
+
+namespace infini
+{
+    /**
+     * @brief Value ranges of the Float32 tensors of a graph, gathered by
+     * running it on representative inputs. GraphObj::quantize derives the
+     * activation scales from them.
+     */
+    class Calibrator
+    {
+        std::unordered_map<UidBaseType, pair<float, float>> ranges; // by fuid
+
+    public:
+        /**
+         * @brief Run `graph` once on the data currently in its inputs and
+         * widen the recorded ranges with its inputs and every Float32
+         * tensor it computes. Call it once per calibration batch.
+         */
+        void collect(const Graph &graph);
+
+        /**
+         * @brief Widen the range of `tensor` with its current data, NaNs
+         * excluded. Tensors of other dtypes are ignored.
+         */
+        void record(const Tensor &tensor);
+
+        optional<pair<float, float>> getRange(const Tensor &tensor) const;
+    };
+
+} // namespace infini
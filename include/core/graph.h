@@ -1,5 +1,7 @@
 #pragma once
 #include "core/allocator.h"
+#include "core/mem_planner.h"
+#include "core/mem_stats.h"
 #include "core/operator.h"
 #include "core/tensor.h"
 #include <algorithm>
@@ -9,6 +11,15 @@
 #include "../operators/matmul.h"
 namespace infini
 {
+    class Calibrator;
+
+    enum class ScheduleMode
+    {
+        // Kahn's algorithm with a FIFO queue, breadth-first.
+        Fifo,
+        // Greedily run the ready op that adds the fewest live bytes.
+        MemoryAware,
+    };
 
     class GraphObj : public Object
     {
@@ -16,11 +27,22 @@ namespace infini
         Runtime runtime;
         TensorVec tensors;
         OpVec ops;
-        Allocator allocator;
+        Allocator allocator;       // transient arena, activations
+        Ref<Allocator> weightAllocator; // persistent arena, weights
+        MemPlanMode planMode;
+        ScheduleMode scheduleMode;
+        MemPlan memPlan;
+        MemStats memStats;
+        bool weightsPacked; // prepacked buffers hold the current weights
+        // weight bytes written into place by the next dataMalloc
+        vector<pair<Tensor, vector<char>>> pendingData;
 
     public:
         explicit GraphObj(Runtime runtime)
-            : runtime(runtime), allocator(runtime), sorted(false){};
+            : runtime(runtime), allocator(runtime),
+              weightAllocator(make_ref<Allocator>(runtime)),
+              planMode(MemPlanMode::Online), scheduleMode(ScheduleMode::Fifo),
+              weightsPacked(false), sorted(false){};
         string toString() const override;
         Runtime getRuntime() const { return runtime; }
 
@@ -53,12 +75,98 @@ namespace infini
          */
         bool topo_sort();
 
+        /**
+         * @brief Choose how topo_sort orders independent ops. dataMalloc plans
+         * memory in that order.
+         */
+        void setScheduleMode(ScheduleMode mode)
+        {
+            scheduleMode = mode;
+            sorted = false;
+        }
+
+        /**
+         * @brief Mark a graph input as a weight holding the getBytes() bytes
+         * at `data`, which are copied. optimize computes the ops whose
+         * inputs are all constants once and replaces them with their
+         * results; dataMalloc writes constants into the persistent arena.
+         */
+        void setConstant(const Tensor &tensor, const void *data);
+
         void optimize();
 
+        /**
+         * @brief Run each MatMul whose B is a Float32 weight in int8. A is
+         * quantized per tensor from the range `calibrator` recorded for it,
+         * B once per output column, and the int32 product is dequantized
+         * into the original output, through the bias and activation folded
+         * into the MatMul if any. Weights already allocated move to a new
+         * persistent arena without the replaced ones, so call dataMalloc
+         * again afterwards.
+         */
+        void quantize(const Calibrator &calibrator);
+
         void shape_infer();
 
         void dataMalloc();
 
+        /**
+         * @brief Let kernels repack constant inputs into the persistent
+         * memory dataMalloc reserved for them. The runtime calls it on the
+         * first run after dataMalloc; call it again after changing weight
+         * data.
+         */
+        void prepack();
+        bool needsPrepack() const { return !weightsPacked; }
+
+        /**
+         * @brief Bind the weights of this graph to the persistent arena of
+         * `other`, which must have been built the same way and already
+         * allocated. Weights are matched in the order they were added. Must
+         * be called before dataMalloc.
+         */
+        void shareWeights(const Graph &other);
+
+        /**
+         * @brief Gets weight tensors of this graph.
+         */
+        TensorVec getWeights() const;
+
+        /**
+         * @brief Select the free-block policy used by dataMalloc. Must be
+         * called before dataMalloc.
+         */
+        void setAllocPolicy(AllocPolicy policy) { allocator.setPolicy(policy); }
+
+        /**
+         * @brief Alignment of every tensor in both arenas. Must be called
+         * before dataMalloc.
+         */
+        void setTensorAlignment(size_t alignment)
+        {
+            allocator.setAlignment(alignment);
+            weightAllocator->setAlignment(alignment);
+        }
+
+        /**
+         * @brief Choose between replaying alloc/free through the allocator
+         * and planning all tensor lifetimes as a whole. Must be called before
+         * dataMalloc.
+         */
+        void setMemPlanMode(MemPlanMode mode) { planMode = mode; }
+
+        /**
+         * @brief The plan computed by the last dataMalloc, with its peak and
+         * the lower bound given by the largest live set.
+         */
+        const MemPlan &getMemPlan() const { return memPlan; }
+
+        /**
+         * @brief Per-tensor placement, per-op live bytes and arena statistics
+         * of the last dataMalloc. Use exportMemStats to dump them.
+         */
+        MemStats getMemStats() const;
+
         /**
          * @brief Add an operator and create its outputs. Output tensor arguments
          * should be empty Refs (e.g., nullptr).
@@ -114,6 +222,47 @@ namespace infini
          */
         void addOperatorAndConnect(const Operator &op);
 
+        /**
+         * @brief Redirect the consumers of each op to an earlier op of the
+         * same attributes on the same inputs, see
+         * OperatorObj::getOpAttrVector, and remove it. Part of optimize.
+         */
+        void eliminateCommonSubexpressions();
+
+        /**
+         * @brief Replace each connected group of Float32 Add, Sub, Mul, Div,
+         * Relu and Clip with one FusedElementwise op, so that intermediate
+         * results never go through memory. Part of optimize.
+         */
+        void fuseElementwise();
+
+        /**
+         * @brief Fold the sole consumers of each MatMul, an Add of one value
+         * per output column and then Relu or Clip, into the MatMul, whose
+         * kernel applies them before storing the output. Part of optimize.
+         */
+        void fuseMatmulEpilogue();
+
+        /**
+         * @brief Run each op whose inputs are all constants through its
+         * kernel and replace it with its outputs, which become constants.
+         * Ops without inputs or producing graph outputs are kept. Does
+         * nothing while the persistent arena is shared with another graph,
+         * see shareWeights, since folding changes the set of weights.
+         * Part of optimize.
+         */
+        void foldConstants();
+
+        // Current bytes of a weight: in the persistent arena once allocated,
+        // otherwise in pendingData. Null if it has neither.
+        const char *weightData(const Tensor &tensor) const;
+        // Queue `bytes` for the next dataMalloc, replacing earlier ones.
+        void stageData(const Tensor &tensor, vector<char> bytes);
+        // After weights were added or removed: stage the allocated ones so
+        // that the next dataMalloc lays out a new persistent arena, and drop
+        // the prepacked buffers that lived in the old one.
+        void restageWeights();
+
         /**
          * @brief If the nodes is sorted in topological order.
          */
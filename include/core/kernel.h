@@ -21,6 +21,27 @@ namespace infini
          */
         virtual void compute(const Operator &op,
                              const RuntimeObj *context) const = 0;
+
+        /**
+         * @brief Whether the output may share memory with an input of the
+         * same shape. True when every output element only depends on the
+         * input element at the same position, so it is read before it is
+         * overwritten.
+         */
+        virtual bool supportInplace() const { return false; }
+
+        /**
+         * @brief Bytes of persistent memory the kernel wants for a copy of
+         * the op's constant inputs in the layout it computes from, 0 if it
+         * uses them as they are. dataMalloc reserves it next to the weights.
+         */
+        virtual size_t getPrepackSize(const Operator &op) const { return 0; }
+
+        /**
+         * @brief Fill `dst` (getPrepackSize bytes) from the current data of
+         * the constant inputs. compute then reads op->getPrepacked().
+         */
+        virtual void prepack(const Operator &op, void *dst) const {}
     };
 
     class KernelRegistry
@@ -59,6 +80,10 @@ namespace infini
                                                "}");
             return std::get<0>(it->second);
         }
+        bool hasKernel(const KernelAttrs &kernelAttrs) const
+        {
+            return kernels.find(kernelAttrs) != kernels.end();
+        }
         const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const
         {
             return kernels.at(kernelAttrs);
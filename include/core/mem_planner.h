@@ -0,0 +1,72 @@
+#pragma once
+#include "core/allocator.h"
+#include "core/common.h"
+
+namespace infini
+{
+    enum class MemPlanMode
+    {
+        // Replay alloc/free through the Allocator in execution order.
+        Online,
+        // Offline planning, place the largest buffers first.
+        GreedyBySize,
+        // Offline planning, visit ops by decreasing live-set size and place
+        // the buffers live at each of them, largest first.
+        GreedyByBreadth,
+    };
+
+    /**
+     * @brief A buffer to be placed in the arena. It is live from the op at
+     * index `first` to the op at index `last` (both inclusive) of the sorted
+     * operator list. `size` is already aligned.
+     */
+    struct MemInterval
+    {
+        size_t size;
+        int first;
+        int last;
+
+        bool overlaps(const MemInterval &rhs) const
+        {
+            return first <= rhs.last && rhs.first <= last;
+        }
+    };
+
+    struct MemPlan
+    {
+        vector<size_t> offsets; // offset of each interval in the arena
+        size_t peak = 0;        // arena size required by the plan
+        size_t lowerBound = 0;  // largest live set, no plan can go below it
+    };
+
+    class MemoryPlanner
+    {
+    public:
+        /**
+         * @brief Assign an offset to every interval.
+         *
+         * @param allocator Only used by MemPlanMode::Online, which replays
+         * the intervals through it and returns the allocator's offsets.
+         * Offline plans start at offset 0.
+         */
+        static MemPlan plan(const vector<MemInterval> &intervals,
+                            MemPlanMode mode, Allocator &allocator);
+
+        static size_t lowerBound(const vector<MemInterval> &intervals);
+
+    private:
+        static MemPlan replay(const vector<MemInterval> &intervals,
+                              Allocator &allocator);
+        static MemPlan greedyBySize(const vector<MemInterval> &intervals);
+        static MemPlan greedyByBreadth(const vector<MemInterval> &intervals);
+
+        /**
+         * @brief Best-fit offset for interval `idx` among the already placed
+         * intervals that overlap it in time.
+         */
+        static size_t findOffset(const vector<MemInterval> &intervals,
+                                 const vector<size_t> &placed,
+                                 const vector<size_t> &offsets, size_t idx);
+    };
+
+} // namespace infini
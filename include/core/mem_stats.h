@@ -0,0 +1,51 @@
+#pragma once
+#include "core/allocator.h"
+#include "core/common.h"
+#include "core/object.h"
+#include "core/op_type.h"
+
+namespace infini
+{
+    struct TensorMemInfo
+    {
+        UidBaseType guid;
+        UidBaseType fuid;
+        bool weight;   // offset is in the persistent arena if true
+        size_t offset; // byte offset in its arena
+        size_t size;   // bytes
+        int first;     // index of the producer in the sorted ops
+        int last;      // index of the last consumer
+    };
+
+    struct OpMemInfo
+    {
+        UidBaseType guid;
+        OpType type;
+        size_t liveBytes; // activation bytes live while the op runs
+    };
+
+    /**
+     * @brief Memory layout recorded by GraphObj::dataMalloc.
+     */
+    struct MemStats
+    {
+        vector<TensorMemInfo> tensors;
+        vector<OpMemInfo> timeline;
+        size_t planPeak = 0;
+        size_t lowerBound = 0;
+        AllocatorStats activation{};
+        AllocatorStats weight{};
+    };
+
+    enum class MemStatsFormat
+    {
+        Json, // the whole MemStats
+        Csv,  // the timeline only, one row per op
+    };
+
+    void exportMemStats(std::ostream &os, const MemStats &stats,
+                        MemStatsFormat format);
+    void exportMemStats(const string &path, const MemStats &stats,
+                        MemStatsFormat format);
+
+} // namespace infini
@@ -24,6 +24,10 @@ namespace infini
             Relu,
             Sub,
             Transpose,
+            QuantizeLinear,
+            DequantizeLinear,
+            MatMulInteger,
+            FusedElementwise,
 
         } type;
 
@@ -18,6 +18,8 @@ namespace infini
         TensorVec outputs;
         vector<WRef<OperatorObj>> predecessors;
         vector<WRef<OperatorObj>> successors;
+        Blob prepacked; // constant inputs repacked by the kernel
+        vector<int> prepackedFor; // see prepackKey
 
     public:
         OperatorObj(OpType opType, TensorVec inputs, TensorVec outputs);
@@ -54,6 +56,21 @@ namespace infini
         DataType getOutDType() const { return getOutput()->getDType(); }
         virtual int numInputs() const = 0;
         virtual int numOutputs() const = 0;
+        /**
+         * @brief The operator type followed by every attribute that affects
+         * the outputs. Ops of equal vectors on the same inputs compute the
+         * same values, see GraphObj::eliminateCommonSubexpressions.
+         */
+        virtual vector<int> getOpAttrVector() const = 0;
+
+        /**
+         * @brief Constant inputs in the kernel's own layout, see
+         * Kernel::prepack. Null if the kernel reads them as they are, or if
+         * the attributes or input shapes changed since the buffer was set:
+         * it is sized and laid out for those.
+         */
+        Blob getPrepacked() const;
+        void setPrepacked(Blob blob);
 
         /**
          * @brief Clone this operator and replace its inputs and outputs.
@@ -68,6 +85,13 @@ namespace infini
     protected:
         optional<vector<Shape>> inferShape();
         vector<DataType> inferDataType() const;
+        // The bits of a float attribute, for getOpAttrVector.
+        static int floatAttr(float value);
+
+    private:
+        // The attributes and input data types and shapes, which determine
+        // the size and layout of a prepacked buffer.
+        vector<int> prepackKey() const;
 
     private:
         void addPredecessors(const Operator &op) { predecessors.emplace_back(op); }
@@ -86,6 +110,7 @@ namespace infini
         op->outputs = newOutputs;                                      \
         op->predecessors.clear();                                      \
         op->successors.clear();                                        \
+        op->prepacked = nullptr;                                       \
         IT_ASSERT(op->checkValid(nullptr));                            \
         return op;                                                     \
     }
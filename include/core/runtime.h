@@ -25,6 +25,10 @@ namespace infini
     CPU = 1
   };
 
+  // Default alignment of arenas and of tensors inside them: one cache line,
+  // which is also the width of an AVX-512 register.
+  constexpr size_t DEFAULT_ALIGNMENT = 64;
+
   class RuntimeObj : public std::enable_shared_from_this<RuntimeObj>
   {
   protected:
@@ -37,10 +41,16 @@ namespace infini
     RuntimeObj &operator=(RuntimeObj const &) = delete;
     virtual ~RuntimeObj() {}
 
+    // Called after each op of a run, once its outputs are computed.
+    using OpCallback = std::function<void(const Operator &)>;
+
     virtual void run(const Graph &graph) const = 0;
+    virtual void run(const Graph &graph, const OpCallback &afterOp) const = 0;
     virtual void *alloc(size_t size) = 0;
     virtual void dealloc(void *ptr) = 0;
 
+    Device getDevice() const { return device; }
+
     bool isCpu() const
     {
       return true;
@@ -51,8 +61,14 @@ namespace infini
 
   class NativeCpuRuntimeObj : public RuntimeObj
   {
+    size_t alignment;
+    bool hugePage; // back large allocations with transparent huge pages
+    bool zeroFill; // zero the memory returned by alloc, like calloc
+
   public:
-    NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
+    NativeCpuRuntimeObj()
+        : RuntimeObj(Device::CPU), alignment(DEFAULT_ALIGNMENT),
+          hugePage(false), zeroFill(true) {}
 
     static Ref<NativeCpuRuntimeObj> &getInstance()
     {
@@ -62,8 +78,25 @@ namespace infini
     }
     void dealloc(void *ptr) override;
     void run(const Graph &graph) const override;
+    void run(const Graph &graph, const OpCallback &afterOp) const override;
     void *alloc(size_t size) override;
     string toString() const override;
+
+    /**
+     * @brief Alignment of the memory returned by alloc, a power of two.
+     */
+    void setAlignment(size_t alignment);
+    size_t getAlignment() const { return alignment; }
+    /**
+     * @brief Advise the kernel to use huge pages for allocations of at least
+     * one huge page, which cuts TLB misses on large arenas. Linux only.
+     */
+    void setHugePage(bool enable) { hugePage = enable; }
+    /**
+     * @brief Disable to skip zeroing the memory, the pages are then only
+     * touched when a kernel first writes them.
+     */
+    void setZeroFill(bool enable) { zeroFill = enable; }
   };
 
 } // namespace infini
@@ -12,6 +12,21 @@ namespace infini
     class GraphObj;
     using ShapeElem = int;
     using Shape = vector<ShapeElem>;
+
+    /**
+     * @brief Affine int8 quantization: real = scale * (q - zeroPoint). A
+     * single scale covers the whole tensor, otherwise scales[i] and
+     * zeroPoints[i] apply to index i of dim `axis`.
+     */
+    struct QuantParams
+    {
+        vector<float> scales;
+        vector<int32_t> zeroPoints;
+        int axis = -1;
+
+        bool perChannel() const { return scales.size() > 1; }
+    };
+
     class TensorObj : public Object
     {
         friend class GraphObj;
@@ -24,6 +39,9 @@ namespace infini
         WRef<OperatorObj> source;
         Blob data;
         Runtime runtime;
+        bool weight; // weights and constants live in the persistent arena
+        bool constant; // a weight whose data the graph has, see GraphObj::setConstant
+        QuantParams quant; // empty unless the tensor holds quantized values
 
     private:
         Shape shape;
@@ -44,6 +62,22 @@ namespace infini
         size_t getRank() const { return shape.size(); }
         UidBaseType getFuid() const { return fuid; }
 
+        /**
+         * @brief Mark a graph input as a weight. Weights are allocated once in
+         * the persistent arena and never reused for activations.
+         */
+        void setWeight() { weight = true; }
+        bool isWeight() const { return weight; }
+        bool isConstant() const { return constant; }
+
+        /**
+         * @brief Scales and zero points of an Int8 or Int32 tensor holding
+         * quantized values, see QuantParams.
+         */
+        void setQuantParams(QuantParams params);
+        const QuantParams &getQuantParams() const { return quant; }
+        bool isQuantized() const { return !quant.scales.empty(); }
+
         void setData(
             std::function<void(void *, size_t, DataType)> const &generator) const;
 
@@ -27,6 +27,7 @@ class ConcatObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return inputs.size(); }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
     int getDim() const { return dim; }
 };
 } // namespace infini
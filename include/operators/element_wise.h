@@ -28,6 +28,7 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 2; }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
     };
 
 #define DEFINE_ELEMENT_WISE_OBJ(prefix, type)                    \
@@ -0,0 +1,46 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief One step of a fused elementwise program. Slots [0, numInputs) hold
+ * the inputs of the operator and slot numInputs + i the result of step i.
+ */
+struct FusedInstr {
+    OpType type; // Add, Sub, Mul, Div, Relu or Clip
+    int a, b;    // operand slots, `b` is ignored by Relu and Clip
+    float lo, hi; // Clip bounds
+};
+
+/**
+ * @brief A chain of Add, Sub, Mul, Div, Relu and Clip evaluated in one pass
+ * over memory. The last step of the program produces the output. Every
+ * input has the shape of the output or a single element, which is
+ * broadcast. Created by GraphObj::optimize.
+ *
+ */
+class FusedElementwiseObj : public OperatorObj {
+    vector<FusedInstr> program;
+
+  public:
+    /**
+     * @brief Construct a new FusedElementwise object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param inputs The tensors the program reads.
+     * @param output The result of the last step.
+     * @param program The steps, each reading inputs or earlier steps.
+     */
+    FusedElementwiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        vector<FusedInstr> program);
+    OP_CLONE(FusedElementwiseObj);
+
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
+    const vector<FusedInstr> &getProgram() const { return program; }
+};
+} // namespace infini
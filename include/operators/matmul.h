@@ -18,6 +18,12 @@ namespace infini
         // Auxiliary attributes which are not a part of operator attributes.
         int m, n, k;
 
+        // Epilogue applied to the product before it is stored: the bias, an
+        // optional third input with one value per output column, then Relu
+        // or Clip to [actMin, actMax]. OpType::Unknown applies nothing.
+        OpType act = OpType::Unknown;
+        float actMin = 0, actMax = 0;
+
     public:
         /**
          * @brief Matmul operator with batch broadcast and tensor transpose
@@ -47,6 +53,7 @@ namespace infini
 
         int numInputs() const override { return inputs.size(); }
         int numOutputs() const override { return 1; }
+        vector<int> getOpAttrVector() const override;
 
         bool getTransA() const { return transA; }
         bool getTransB() const { return transB; }
@@ -55,6 +62,39 @@ namespace infini
         int getM() const { return m; }
         int getN() const { return n; }
         int getK() const { return k; }
+        Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
+        OpType getAct() const { return act; }
+        float getActMin() const { return actMin; }
+        float getActMax() const { return actMax; }
+        /**
+         * @brief Apply `act`, Relu or Clip to [actMin, actMax], to the output.
+         * GraphObj::optimize folds the Relu and Clip consumers of a matmul
+         * this way, along with a bias Add.
+         */
+        void setAct(OpType act, float actMin = 0, float actMax = 0);
+
+    protected:
+        // For ops following the matmul shape rules, which check validity
+        // themselves once their own overrides are in place.
+        MatmulObj(OpType type, Tensor A, Tensor B, Tensor C, bool transA,
+                  bool transB);
+    };
+
+    /**
+     * @brief Int8 matmul accumulated exactly in int32, ONNX MatMulInteger:
+     * C = (A - zeroPoint(A)) * (B - zeroPoint(B)). The zero points come from
+     * the quantization parameters of A, which must be per tensor, and of B,
+     * per tensor or per output column. Inputs without parameters use 0.
+     */
+    class MatmulIntegerObj : public MatmulObj
+    {
+    public:
+        MatmulIntegerObj(GraphObj *graph, Tensor A, Tensor B, Tensor C,
+                         bool transA = false, bool transB = false);
+        OP_CLONE(MatmulIntegerObj);
+
+        std::string toString() const override;
+        vector<DataType> inferDataType(const TensorVec &inputs) const override;
     };
 
 } // namespace infini
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Quantize a Float32 tensor to Int8, ONNX QuantizeLinear:
+ * q = saturate(round(x / scale) + zeroPoint), rounding half to even.
+ *
+ */
+class QuantizeLinearObj : public OperatorObj {
+    QuantParams params;
+
+  public:
+    /**
+     * @brief Construct a new QuantizeLinear object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The Float32 input tensor.
+     * @param output The Int8 output tensor, which is given `params`.
+     * @param params Per-tensor or per-channel scales and zero points.
+     */
+    QuantizeLinearObj(GraphObj *graph, Tensor input, Tensor output,
+                      QuantParams params);
+    OP_CLONE(QuantizeLinearObj);
+
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
+    const QuantParams &getParams() const { return params; }
+};
+
+/**
+ * @brief Dequantize an Int8 or Int32 tensor to Float32 with the quantization
+ * parameters of the input, ONNX DequantizeLinear:
+ * x = (q - zeroPoint) * scale.
+ *
+ */
+class DequantizeLinearObj : public OperatorObj {
+  public:
+    DequantizeLinearObj(GraphObj *graph, Tensor input, Tensor output);
+    OP_CLONE(DequantizeLinearObj);
+
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+    vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
+};
+} // namespace infini
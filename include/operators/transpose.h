@@ -26,6 +26,7 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
     std::vector<int> getPermute() const { return transposePermute; }
 
   private:
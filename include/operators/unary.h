@@ -24,6 +24,7 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
   };
 
   class ClipObj : public OperatorObj
@@ -39,6 +40,7 @@ namespace infini
     std::optional<float> getMax() const { return maxValue; };
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
 
   private:
     std::optional<float> minValue, maxValue;
@@ -86,6 +88,7 @@ namespace infini
     DataType getOutputDataType() const;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getOpAttrVector() const override;
 
   private:
     CastType castType;
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+namespace infini {
+
+enum class CpuIsa { Scalar, AVX2, AVX512 };
+
+// The widest SIMD level usable on this CPU, detected once on first call.
+// Setting INFINI_CPU_ISA to scalar, avx2 or avx512 caps it, which is how the
+// fallback paths are exercised on newer machines.
+CpuIsa getCpuIsa();
+
+const char *toString(CpuIsa isa);
+
+// Whether the AVX-512 level is in use and the CPU also has the VNNI int8 dot
+// product instructions.
+bool hasAvx512Vnni();
+
+// Size in bytes of the largest CPU cache, detected once on first call. Copies
+// whose destination exceeds it bypass the caches with non-temporal stores.
+size_t getLastLevelCacheSize();
+
+// Kernels compile their SIMD variants with per-function target attributes and
+// pick one through getCpuIsa(), so the library itself needs no -march flag.
+#if defined(__x86_64__) || defined(__i386__)
+#define IT_X86 1
+#define IT_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define IT_TARGET_AVX512                                                       \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx2,fma,f16c")))
+#define IT_TARGET_AVX512VNNI                                                   \
+    __attribute__((                                                            \
+        target("avx512vnni,avx512f,avx512bw,avx512vl,avx2,fma,f16c")))
+#endif
+
+} // namespace infini
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace infini {
+
+// Float16 and BFloat16 tensors store raw bit patterns in uint16_t, see
+// DT<10> and DT<16>. These convert one value, rounding to nearest even the
+// way F16C and ONNX do. NaNs stay NaNs, with the quiet bit set.
+
+inline float fp16ToFloat(uint16_t h) {
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t em = h & 0x7fff, bits;
+    if (em > 0x7c00) // NaN
+        bits = sign | 0x7fc00000 | ((em & 0x3ff) << 13);
+    else if (em == 0x7c00)
+        bits = sign | 0x7f800000;
+    else if (em >= 0x400) // normal: rebias the exponent from 15 to 127
+        bits = sign | ((em << 13) + 0x38000000);
+    else { // zero or subnormal: em units of 2^-24, exact in float
+        float f = em * 0x1p-24f;
+        std::memcpy(&bits, &f, sizeof(bits));
+        bits |= sign;
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline uint16_t floatToFp16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t abs = bits & 0x7fffffff;
+    if (abs > 0x7f800000) // NaN
+        return sign | 0x7e00 | ((abs >> 13) & 0x3ff);
+    if (abs >= 0x477ff000) // inf, or rounds up past 65504
+        return sign | 0x7c00;
+    if (abs < 0x38800000) {
+        // below 2^-14: adding 0.5 leaves the value rounded to a multiple of
+        // 2^-24 in the low mantissa bits
+        float a;
+        std::memcpy(&a, &abs, sizeof(a));
+        a += 0.5f;
+        uint32_t r;
+        std::memcpy(&r, &a, sizeof(r));
+        return sign | (r - 0x3f000000);
+    }
+    // rebias the exponent from 127 to 15 and round the 13 dropped bits
+    abs += 0xc8000fff + ((abs >> 13) & 1);
+    return sign | (abs >> 13);
+}
+
+inline float bf16ToFloat(uint16_t h) {
+    uint32_t bits = uint32_t(h) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline uint16_t floatToBf16(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7fffffff) > 0x7f800000)
+        return (bits >> 16) | 0x40;
+    return (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+}
+
+// Convert n contiguous values with the widest SIMD the CPU supports: F16C
+// for Float16 and integer vector ops for BFloat16. Results match the scalar
+// functions above.
+void convertFp16ToFloat(float *dst, const uint16_t *src, size_t n);
+void convertFloatToFp16(uint16_t *dst, const float *src, size_t n);
+void convertBf16ToFloat(float *dst, const uint16_t *src, size_t n);
+void convertFloatToBf16(uint16_t *dst, const float *src, size_t n);
+
+// Row converters of a half-precision storage type, `bf16` picking BFloat16
+// over Float16.
+inline auto halfToFloatOf(bool bf16) {
+    return bf16 ? convertBf16ToFloat : convertFp16ToFloat;
+}
+
+inline auto floatToHalfOf(bool bf16) {
+    return bf16 ? convertFloatToBf16 : convertFloatToFp16;
+}
+
+} // namespace infini
@@ -18,6 +18,9 @@ Shape locate_index(size_t inputN, const Shape &shape);
 // Delocate the ShapeIndex from Shape with broadcast
 size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
                       const Shape &stride);
+// Element offset of the matrix used by each output batch of a matmul, for an
+// operand whose batch dims broadcast to those of outDims
+vector<size_t> batch_offsets(const Shape &dims, const Shape &outDims);
 // Convert KernelAttrs to a string representation
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs);
 
@@ -0,0 +1,50 @@
+#include "core/calibrator.h"
+#include "core/runtime.h"
+
+namespace infini
+{
+    void Calibrator::collect(const Graph &graph)
+    {
+        // 激活值可能原地复用输入的内存，输入要在运行前记录
+        for (auto &input : graph->getInputs())
+            if (!input->isWeight())
+                record(input);
+        auto afterOp = [this](const Operator &op)
+        {
+            for (auto &output : op->getOutputs())
+                record(output);
+        };
+        graph->getRuntime()->run(graph, afterOp);
+    }
+
+    void Calibrator::record(const Tensor &tensor)
+    {
+        if (!(tensor->getDType() == DataType::Float32) || tensor->size() == 0)
+            return;
+        auto data = tensor->getRawDataPtr<float *>();
+        float lo = INFINITY, hi = -INFINITY;
+        for (size_t i = 0; i < tensor->size(); ++i)
+        {
+            lo = std::min(lo, data[i]);
+            hi = std::max(hi, data[i]);
+        }
+        if (lo > hi) // all NaN
+            return;
+        auto [it, inserted] = ranges.try_emplace(tensor->getFuid(), lo, hi);
+        if (!inserted)
+        {
+            it->second.first = std::min(it->second.first, lo);
+            it->second.second = std::max(it->second.second, hi);
+        }
+    }
+
+    optional<pair<float, float>>
+    Calibrator::getRange(const Tensor &tensor) const
+    {
+        auto it = ranges.find(tensor->getFuid());
+        if (it == ranges.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+} // namespace infini
@@ -1,8 +1,19 @@
 #include "core/graph.h"
+#include "core/calibrator.h"
+#include "core/kernel.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/quantize.h"
+#include "operators/unary.h"
 #include <algorithm>
 #include <iterator>
 #include <numeric>
-#include <queue>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <limits>
 
 namespace infini
 {
@@ -69,7 +80,7 @@ namespace infini
         
         // Use Kahn's algorithm for O(V+E) complexity
         std::unordered_map<OperatorObj *, int> inDegree;
-        std::queue<Operator> zeroInDegree;
+        std::deque<Operator> zeroInDegree;
         std::vector<Operator> sorted;
         sorted.reserve(ops.size());
         inDegree.reserve(ops.size());
@@ -92,23 +103,67 @@ namespace infini
         {
             if (inDegree[op.get()] == 0)
             {
-                zeroInDegree.push(op);
+                zeroInDegree.push_back(op);
             }
         }
+
+        // Number of consumers of each tensor that are not scheduled yet
+        std::unordered_map<TensorObj *, int> pendingTargets;
+        for (const auto &tensor : tensors)
+        {
+            auto targets = tensor->getTargets();
+            pendingTargets[tensor.get()] =
+                std::unordered_set<Operator>(targets.begin(), targets.end()).size();
+        }
+        // Bytes that become live minus bytes released by running `op` now.
+        // Graph inputs, graph outputs and weights are never released.
+        auto memoryDelta = [&](const Operator &op)
+        {
+            long long delta = 0;
+            for (const auto &output : op->getOutputs())
+                delta += output->getBytes();
+            std::unordered_set<TensorObj *> released;
+            for (const auto &input : op->getInputs())
+                if (input->getSource() && !input->getTargets().empty() &&
+                    pendingTargets[input.get()] == 1 && released.insert(input.get()).second)
+                    delta -= input->getBytes();
+            return delta;
+        };
         
         // Process operators in topological order
         while (!zeroInDegree.empty())
         {
-            auto current = zeroInDegree.front();
-            zeroInDegree.pop();
+            // FIFO yields a breadth-first order. The memory-aware mode instead
+            // picks the ready op that grows the live set the least, ties go to
+            // the op that became ready first.
+            size_t pick = 0;
+            if (scheduleMode == ScheduleMode::MemoryAware)
+            {
+                long long best = LLONG_MAX;
+                for (size_t i = 0; i < zeroInDegree.size(); ++i)
+                {
+                    auto delta = memoryDelta(zeroInDegree[i]);
+                    if (delta < best)
+                    {
+                        best = delta;
+                        pick = i;
+                    }
+                }
+            }
+            auto current = zeroInDegree[pick];
+            zeroInDegree.erase(zeroInDegree.begin() + pick);
             sorted.emplace_back(current);
+            std::unordered_set<TensorObj *> consumed;
+            for (const auto &input : current->getInputs())
+                if (consumed.insert(input.get()).second)
+                    --pendingTargets[input.get()];
             
             // Decrement in-degree for successors
             for (const auto &succ : current->getSuccessors())
             {
                 if (--inDegree[succ.get()] == 0)
                 {
-                    zeroInDegree.push(succ);
+                    zeroInDegree.push_back(succ);
                 }
             }
         }
@@ -132,6 +187,9 @@ namespace infini
     // 2. 合并算子（例如，矩阵乘算子中含有属性transA、transB，如果其输入存在transpose，且对最后两个维度做交换，就可以将transpose融入到矩阵乘算子的属性中去）
     // =================================== 作业 ===================================
     
+    // Step 0: Fold operators whose inputs are all constants
+    foldConstants();
+
     // Step 1: Remove redundant transpose operators
     bool modified = true;
     while (modified) {
@@ -174,7 +232,8 @@ namespace infini
                 }
             }
             
-            if (!isInverse) {
+            // 第二个 transpose 的输出是图的输出时不能删除
+            if (!isInverse || succOp->getOutput()->getTargets().empty()) {
                 ++it;
                 continue;
             }
@@ -202,6 +261,7 @@ namespace infini
             for (auto targetOp : outputTensor->getTargets()) {
                 inputTensor->addTarget(targetOp);
                 targetOp->replaceInput(outputTensor, inputTensor);
+                targetOp->removePredecessors(succOp);
             }
             
             // 删除操作符
@@ -308,7 +368,14 @@ namespace infini
                 // 更新连接
                 op->replaceInput(inputTensor, bypassTensor);
                 bypassTensor->addTarget(op);
+                bypassTensor->removeTarget(sourceOp);
                 inputTensor->removeTarget(op);
+                op->removePredecessors(sourceOp);
+                if (auto pred = bypassTensor->getSource()) {
+                    pred->removeSuccessors(sourceOp);
+                    pred->addSuccessors(op);
+                    op->addPredecessors(pred);
+                }
                 
                 // 删除transpose操作符
                 auto transposeIt = std::find(ops.begin(), ops.end(), sourceOp);
@@ -345,7 +412,486 @@ namespace infini
             }
         }
     }
+
+    // Step 3: Merge operators computing the same values
+    eliminateCommonSubexpressions();
+
+    // Step 4: Fold bias and activation into matmul operators
+    fuseMatmulEpilogue();
+
+    // Step 5: Fuse chains of elementwise operators
+    fuseElementwise();
 }
+
+    void GraphObj::eliminateCommonSubexpressions()
+    {
+        IT_ASSERT(topo_sort() == true);
+        // 输出的数据类型和量化参数也要相同，它们决定了后继怎样读取输出
+        auto sameOutputs = [](const Operator &a, const Operator &b)
+        {
+            for (size_t i = 0; i < a->outputs.size(); ++i)
+            {
+                auto &qa = a->outputs[i]->getQuantParams(), &qb = b->outputs[i]->getQuantParams();
+                if (!(a->outputs[i]->getDType() == b->outputs[i]->getDType()) ||
+                    qa.scales != qb.scales || qa.zeroPoints != qb.zeroPoints || qa.axis != qb.axis)
+                    return false;
+            }
+            return true;
+        };
+        // 按拓扑序遍历，算子被合并后它的后继读取相同的输入，随后也能被合并
+        std::unordered_map<size_t, OpVec> kept;
+        for (auto &op : OpVec(ops))
+        {
+            auto attrs = op->getOpAttrVector();
+            size_t key = attrs.size();
+            for (auto attr : attrs)
+                key = key * 31 + std::hash<int>{}(attr);
+            for (auto &input : op->inputs)
+                key = key * 31 + std::hash<UidBaseType>{}(input->getFuid());
+            Operator same;
+            for (auto &prev : kept[key])
+                if (prev->inputs == op->inputs && prev->getOpAttrVector() == attrs &&
+                    sameOutputs(prev, op))
+                {
+                    same = prev;
+                    break;
+                }
+            // 输出是图的输出时保留
+            bool graphOutput = false;
+            for (auto &output : op->outputs)
+                graphOutput = graphOutput || output->getTargets().empty();
+            if (!same || graphOutput)
+            {
+                kept[key].emplace_back(op);
+                continue;
+            }
+
+            // 后继改为读取 same 的输出
+            for (size_t i = 0; i < op->outputs.size(); ++i)
+            {
+                auto output = op->outputs[i], replacement = same->outputs[i];
+                auto targets = output->getTargets();
+                for (auto &target : targets)
+                {
+                    target->replaceInput(output, replacement);
+                    target->removePredecessors(op);
+                }
+                for (auto &target : targets)
+                {
+                    replacement->addTarget(target);
+                    target->addPredecessors(same);
+                    same->addSuccessors(target);
+                }
+                removeTensor(output);
+            }
+            for (auto &input : op->inputs)
+                input->removeTarget(op);
+            for (auto &pred : op->getPredecessors())
+                pred->removeSuccessors(op);
+            removeOperator(op);
+        }
+    }
+
+    void GraphObj::fuseMatmulEpilogue()
+    {
+        for (auto &op : OpVec(ops))
+        {
+            if (op->getOpType() != OpType::MatMul)
+                continue;
+            auto matmul = as<MatmulObj>(op);
+            // 输出只被一个算子使用（因此不是图的输出）时，返回这个算子
+            auto consumer = [&]() -> Operator
+            {
+                auto targets = op->getOutput()->getTargets();
+                return targets.size() == 1 ? targets[0] : nullptr;
+            };
+            // 删除 next 和原来的输出，由 MatMul 直接写出 next 的输出
+            auto absorb = [&](const Operator &next)
+            {
+                auto C = op->getOutput(), out = next->getOutput();
+                for (auto &input : next->getInputs())
+                    input->removeTarget(next);
+                for (auto &pred : next->getPredecessors())
+                    pred->removeSuccessors(next);
+                for (auto &succ : next->getSuccessors())
+                {
+                    succ->removePredecessors(next);
+                    succ->addPredecessors(op);
+                    op->addSuccessors(succ);
+                }
+                removeOperator(next);
+                removeTensor(C);
+                out->setSource(op);
+                op->outputs[0] = out;
+                sorted = false;
+            };
+
+            // bias 每个输出列一个值，与输出的数据类型相同
+            auto add = consumer();
+            if (add && add->getOpType() == OpType::Add && !matmul->getBias() &&
+                matmul->getAct() == OpType::Unknown)
+            {
+                auto C = op->getOutput();
+                auto bias = add->getInputs(0) == C ? add->getInputs(1) : add->getInputs(0);
+                int n = matmul->getN();
+                if (bias != C && bias->getDType() == C->getDType() &&
+                    bias->size() == size_t(n) && bias->getRank() > 0 &&
+                    bias->getDims().back() == n && bias->getRank() <= C->getRank())
+                {
+                    absorb(add);
+                    op->inputs.emplace_back(bias);
+                    bias->addTarget(op);
+                    if (auto pred = bias->getSource())
+                    {
+                        pred->addSuccessors(op);
+                        op->addPredecessors(pred);
+                    }
+                    IT_ASSERT(op->checkValid(nullptr));
+                }
+            }
+
+            auto act = consumer();
+            if (act && matmul->getAct() == OpType::Unknown)
+            {
+                if (act->getOpType() == OpType::Relu)
+                {
+                    matmul->setAct(OpType::Relu);
+                    absorb(act);
+                }
+                else if (act->getOpType() == OpType::Clip)
+                {
+                    auto clip = as<ClipObj>(act);
+                    matmul->setAct(OpType::Clip,
+                                   clip->getMin().value_or(std::numeric_limits<float>::lowest()),
+                                   clip->getMax().value_or(std::numeric_limits<float>::max()));
+                    absorb(act);
+                }
+            }
+        }
+    }
+
+    void GraphObj::fuseElementwise()
+    {
+        IT_ASSERT(topo_sort() == true);
+        // kernel 只支持 Float32，输入与输出同形状或只有一个元素
+        auto fusible = [](const Operator &op)
+        {
+            auto type = op->getOpType();
+            if (!(type == OpType::Add || type == OpType::Sub || type == OpType::Mul ||
+                  type == OpType::Div || type == OpType::Relu || type == OpType::Clip) ||
+                !(op->getDType() == DataType::Float32))
+                return false;
+            auto size = op->getOutput()->size();
+            for (auto &input : op->getInputs())
+                if (input->size() != 1 && input->size() != size)
+                    return false;
+            return true;
+        };
+        // tensor 只被一个可融合的算子使用一次、且与其输出同形状时，可以留在组内
+        auto internal = [&](const Tensor &tensor) -> Operator
+        {
+            auto source = tensor->getSource();
+            auto targets = tensor->getTargets();
+            if (!source || !fusible(source) || targets.size() != 1 ||
+                !fusible(targets[0]) || tensor->size() != targets[0]->getOutput()->size())
+                return nullptr;
+            return targets[0];
+        };
+
+        std::unordered_set<OperatorObj *> fused;
+        for (auto &sink : OpVec(ops))
+        {
+            // 从组的出口算子出发，向输入方向收集整个组
+            if (fused.count(sink.get()) || !fusible(sink) || internal(sink->getOutput()))
+                continue;
+            TensorVec inputs, inner;
+            OpVec group;
+            vector<FusedInstr> program;
+            std::unordered_map<TensorObj *, int> inputSlot;
+            // 后序生成程序；步骤的结果暂记为 -(i + 1)，输入个数确定后再换成槽位号
+            std::function<int(const Operator &)> emit = [&](const Operator &op)
+            {
+                group.emplace_back(op);
+                vector<int> slots;
+                for (auto &input : op->getInputs())
+                {
+                    if (internal(input) == op)
+                    {
+                        inner.emplace_back(input);
+                        slots.emplace_back(emit(input->getSource()));
+                        continue;
+                    }
+                    auto [it, inserted] = inputSlot.try_emplace(input.get(), inputs.size());
+                    if (inserted)
+                        inputs.emplace_back(input);
+                    slots.emplace_back(it->second);
+                }
+                FusedInstr instr{op->getOpType(), slots[0], slots.back(), 0.f, 0.f};
+                if (op->getOpType() == OpType::Clip)
+                {
+                    auto clip = as<ClipObj>(op);
+                    instr.lo = clip->getMin().value_or(std::numeric_limits<float>::lowest());
+                    instr.hi = clip->getMax().value_or(std::numeric_limits<float>::max());
+                }
+                program.emplace_back(instr);
+                return -int(program.size());
+            };
+            emit(sink);
+            if (group.size() < 2)
+                continue;
+            int nInputs = inputs.size();
+            for (auto &instr : program)
+            {
+                if (instr.a < 0)
+                    instr.a = nInputs - instr.a - 1;
+                if (instr.b < 0)
+                    instr.b = nInputs - instr.b - 1;
+            }
+
+            // 断开组内的算子，由一个融合算子写回原来的输出
+            auto output = sink->getOutput();
+            for (auto &op : group)
+            {
+                for (auto &input : op->getInputs())
+                    input->removeTarget(op);
+                for (auto &pred : op->getPredecessors())
+                    pred->removeSuccessors(op);
+                for (auto &succ : op->getSuccessors())
+                    succ->removePredecessors(op);
+                removeOperator(op);
+                fused.insert(op.get());
+            }
+            for (auto &tensor : inner)
+                removeTensor(tensor);
+            output->source.reset();
+            addOpWithOutputs<FusedElementwiseObj>(inputs, output, std::move(program));
+        }
+    }
+    void GraphObj::quantize(const Calibrator &calibrator)
+    {
+        IT_ASSERT(topo_sort() == true);
+
+        // 同一个激活值被多个 MatMul 使用时只量化一次
+        std::unordered_map<TensorObj *, Tensor> quantized;
+        bool changed = false;
+        for (auto &op : OpVec(ops))
+        {
+            if (op->getOpType() != OpType::MatMul)
+                continue;
+            auto matmul = as<MatmulObj>(op);
+            auto A = matmul->getInputs(0), B = matmul->getInputs(1);
+            auto C = matmul->getOutput();
+            auto range = calibrator.getRange(A);
+            auto b = reinterpret_cast<const float *>(weightData(B));
+            if (!(matmul->getDType() == DataType::Float32) || !B->isWeight() ||
+                !b || !range || matmul->getK() == 0)
+                continue;
+
+            // 激活值按张量做非对称量化，范围包含 0，保证 0 能被精确表示
+            auto &Aq = quantized[A.get()];
+            if (!Aq)
+            {
+                float lo = std::min(range->first, 0.f);
+                float hi = std::max(range->second, 0.f);
+                float scale = hi > lo ? (hi - lo) / 255.f : 1.f;
+                int32_t zeroPoint = std::clamp<int32_t>(
+                    std::lround(-128.f - lo / scale), -128, 127);
+                Aq = addOp<QuantizeLinearObj>(A, nullptr,
+                                              QuantParams{{scale}, {zeroPoint}})
+                         ->getOutput();
+            }
+
+            // 权重按输出列做对称量化，零点为 0，[-127, 127]
+            int n = matmul->getN(), rank = B->getRank();
+            size_t inner = matmul->getTransB() ? matmul->getK() : 1;
+            vector<float> maxAbs(n, 0.f);
+            for (size_t e = 0; e < B->size(); ++e)
+                maxAbs[e / inner % n] = std::max(maxAbs[e / inner % n], std::fabs(b[e]));
+            QuantParams paramsB{vector<float>(n), vector<int32_t>(n, 0),
+                                matmul->getTransB() ? rank - 2 : rank - 1};
+            for (int j = 0; j < n; ++j)
+                paramsB.scales[j] = maxAbs[j] > 0 ? maxAbs[j] / 127.f : 1.f;
+            vector<char> bytes(B->size());
+            for (size_t e = 0; e < B->size(); ++e)
+            {
+                float q = std::nearbyint(b[e] / paramsB.scales[e / inner % n]);
+                bytes[e] = int8_t(std::clamp(q, -127.f, 127.f));
+            }
+            auto Bq = addTensor(B->getDims(), DataType::Int8);
+            Bq->setWeight();
+            Bq->setQuantParams(paramsB);
+            stageData(Bq, std::move(bytes));
+
+            // 断开原 MatMul，由 MatmulInteger + Dequantize 写回原来的输出
+            for (auto &input : op->getInputs())
+                input->removeTarget(op);
+            for (auto &pred : op->getPredecessors())
+                pred->removeSuccessors(op);
+            for (auto &succ : op->getSuccessors())
+                succ->removePredecessors(op);
+            C->source.reset();
+            removeOperator(op);
+
+            auto Cq = addOp<MatmulIntegerObj>(Aq, Bq, nullptr, matmul->getTransA(),
+                                              matmul->getTransB())
+                          ->getOutput();
+            float scaleA = Aq->getQuantParams().scales[0];
+            QuantParams paramsC{vector<float>(n), vector<int32_t>(n, 0),
+                                int(Cq->getRank()) - 1};
+            for (int j = 0; j < n; ++j)
+                paramsC.scales[j] = scaleA * paramsB.scales[j];
+            Cq->setQuantParams(paramsC);
+            // 融合进 MatMul 的 bias 和激活函数重新作为单独的算子，写回原来的输出
+            auto bias = matmul->getBias();
+            auto act = matmul->getAct();
+            bool hasAct = !(act == OpType::Unknown);
+            auto D = bias || hasAct ? addTensor(C->getDims(), DataType::Float32) : C;
+            addOpWithOutputs<DequantizeLinearObj>(Cq, D);
+            if (bias)
+            {
+                auto E = hasAct ? addTensor(C->getDims(), DataType::Float32) : C;
+                addOpWithOutputs<AddObj>(D, bias, E);
+                D = E;
+            }
+            if (act == OpType::Relu)
+                addOpWithOutputs<ReluObj>(D, C);
+            else if (act == OpType::Clip)
+                addOpWithOutputs<ClipObj>(D, C, matmul->getActMin(), matmul->getActMax());
+            if (B->getTargets().empty())
+                removeTensor(B);
+            changed = true;
+        }
+        // 被替换的 float 权重和它们的预打包数据不再占用持久内存
+        if (changed)
+            restageWeights();
+    }
+
+    const char *GraphObj::weightData(const Tensor &tensor) const
+    {
+        // 已经分配的在持久内存中，否则在等待写入的暂存区中
+        if (tensor->data != nullptr)
+            return tensor->getRawDataPtr<char *>();
+        for (auto &[pending, bytes] : pendingData)
+            if (pending == tensor)
+                return bytes.data();
+        return nullptr;
+    }
+
+    void GraphObj::stageData(const Tensor &tensor, vector<char> bytes)
+    {
+        IT_ASSERT(bytes.size() == tensor->getBytes());
+        for (auto &[pending, staged] : pendingData)
+            if (pending == tensor)
+            {
+                staged = std::move(bytes);
+                return;
+            }
+        pendingData.emplace_back(tensor, std::move(bytes));
+    }
+
+    void GraphObj::restageWeights()
+    {
+        // 持久内存已经分配时，把仍在使用的权重暂存起来，下次 dataMalloc 在新的
+        // 持久内存中重新分配
+        if (weightAllocator->getCapacity() != 0)
+        {
+            for (auto &tensor : tensors)
+                if (tensor->isWeight() && tensor->data != nullptr)
+                {
+                    auto ptr = tensor->getRawDataPtr<char *>();
+                    stageData(tensor, vector<char>(ptr, ptr + tensor->getBytes()));
+                    tensor->data = nullptr;
+                }
+            auto alignment = weightAllocator->getAlignment();
+            weightAllocator = make_ref<Allocator>(runtime);
+            weightAllocator->setAlignment(alignment);
+        }
+        for (auto &op : ops)
+            op->setPrepacked(nullptr);
+        weightsPacked = false;
+    }
+
+    void GraphObj::setConstant(const Tensor &tensor, const void *data)
+    {
+        IT_ASSERT(!tensor->getSource(), "Only graph inputs can be constants");
+        IT_ASSERT(tensor->data == nullptr || tensor->isWeight(),
+                  "An allocated activation cannot become a constant");
+        tensor->weight = tensor->constant = true;
+        auto bytes = static_cast<const char *>(data);
+        if (tensor->data != nullptr)
+            std::memcpy(tensor->getRawDataPtr<char *>(), bytes, tensor->getBytes());
+        else
+            stageData(tensor, vector<char>(bytes, bytes + tensor->getBytes()));
+    }
+
+    void GraphObj::foldConstants()
+    {
+        IT_ASSERT(topo_sort() == true);
+        // 与其他图共享的持久内存不能改变：折叠会增删权重，并把它们重新放到本图私有的持久内存中
+        if (weightAllocator.use_count() > 1)
+            return;
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        bool changed = false;
+        for (auto &op : OpVec(ops))
+        {
+            // 没有输入的算子不一定是常量；图的输出保留它的算子
+            auto attrs = KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            bool foldable = kernelRegistry.hasKernel(attrs) && !op->getInputs().empty();
+            for (auto &input : op->getInputs())
+                foldable = foldable && input->isConstant();
+            for (auto &output : op->getOutputs())
+                foldable = foldable && !output->getTargets().empty();
+            if (!foldable)
+                continue;
+
+            // 还在暂存区的输入临时绑定到暂存的数据上，输出写到新的暂存数据中
+            TensorVec unbound;
+            for (auto &input : op->getInputs())
+                if (input->data == nullptr)
+                {
+                    input->setDataBlob(make_ref<BlobObj>(runtime, const_cast<char *>(weightData(input))));
+                    unbound.emplace_back(input);
+                }
+            vector<vector<char>> results;
+            for (auto &output : op->getOutputs())
+            {
+                results.emplace_back(output->getBytes());
+                output->setDataBlob(make_ref<BlobObj>(runtime, results.back().data()));
+            }
+            kernelRegistry.getKernel(attrs)->compute(op, runtime.get());
+            for (auto &input : unbound)
+                input->data = nullptr;
+
+            // 输出成为常量，按拓扑序继续折叠它的后继
+            for (auto &input : op->getInputs())
+                input->removeTarget(op);
+            for (auto &succ : op->getSuccessors())
+                succ->removePredecessors(op);
+            removeOperator(op);
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                auto &output = op->getOutputs()[i];
+                output->source.reset();
+                output->data = nullptr;
+                output->weight = output->constant = true;
+                stageData(output, std::move(results[i]));
+            }
+            // 不再被使用的常量输入连同暂存的数据一起删除
+            for (auto &input : op->getInputs())
+                if (input->getTargets().empty())
+                {
+                    removeTensor(input);
+                    pendingData.erase(std::remove_if(pendingData.begin(), pendingData.end(),
+                                                     [&](const auto &pending)
+                                                     { return pending.first == input; }),
+                                      pendingData.end());
+                }
+            changed = true;
+        }
+        if (changed)
+            restageWeights();
+    }
+
     Tensor GraphObj::getTensor(int fuid) const
     {
         for (auto tensor : tensors)
@@ -360,6 +906,8 @@ namespace infini
 
     void GraphObj::shape_infer()
     {
+        // 按拓扑序推导，保证每个算子的输入形状已经更新
+        IT_ASSERT(topo_sort() == true);
         for (auto &op : ops)
         {
             auto ans = op->inferShape();
@@ -385,6 +933,9 @@ namespace infini
     {
         // topological sorting first
         IT_ASSERT(topo_sort() == true);
+        // 每次调用都重新规划激活值的内存（例如 shape_infer 改变了形状之后），
+        // 已有的内存足够时直接复用，不够时才重新申请
+        allocator.reset();
 
         // =================================== 作业 ===================================
         // TODO：利用 allocator 给计算图分配内存
@@ -392,23 +943,249 @@ namespace infini
         // =================================== 作业 ===================================
         
 
-        std::vector<size_t> tensorOffsets; // 获取所有 tensor 的 offset
+        // 每个 tensor 从产生它的算子开始存活，到最后一个消费者为止。
+        // 图的输入和输出在整个生命周期内都保持占用，其余 tensor 释放后的
+        // 内存可以被后面的 tensor 复用
+        int nOps = ops.size();
+        std::unordered_map<OperatorObj *, int> opIndex;
+        for (int i = 0; i < nOps; ++i)
+            opIndex[ops[i].get()] = i;
+        std::unordered_map<TensorObj *, size_t> tensorIndex;
+        vector<MemInterval> intervals;
+        for (auto &tensor : tensors)
+        {
+            MemInterval interval{allocator.getAlignedSize(tensor->getBytes()), 0, nOps};
+            if (auto source = tensor->getSource())
+                interval.first = opIndex.at(source.get());
+            if (tensor->getSource() && !tensor->getTargets().empty())
+            {
+                interval.last = interval.first;
+                for (auto &target : tensor->getTargets())
+                    interval.last = std::max(interval.last, opIndex.at(target.get()));
+            }
+            tensorIndex[tensor.get()] = intervals.size();
+            intervals.emplace_back(interval);
+        }
+
+        auto tensorIntervals = intervals;
+
+        // 一个 buffer 可以被多个 tensor 共享，每个 tensor 位于其 buffer 内的
+        // bufferOffset 处。初始时每个 tensor 独占一个 buffer
+        vector<size_t> bufferOf(tensors.size()), bufferOffset(tensors.size(), 0);
+        for (size_t i = 0; i < tensors.size(); ++i)
+            bufferOf[i] = i;
+        // weights 不参与激活值的内存规划
+        vector<bool> bufferAlive(tensors.size());
+        for (size_t i = 0; i < tensors.size(); ++i)
+            bufferAlive[i] = !tensors[i]->isWeight();
+        auto mergeInto = [&](size_t from, size_t to, size_t offset)
+        {
+            for (size_t t = 0; t < tensors.size(); ++t)
+                if (bufferOf[t] == from)
+                {
+                    bufferOf[t] = to;
+                    bufferOffset[t] += offset;
+                }
+            intervals[to].first = std::min(intervals[to].first, intervals[from].first);
+            intervals[to].last = std::max(intervals[to].last, intervals[from].last);
+            bufferAlive[from] = false;
+        };
 
-        for (auto &tensor : tensors) { // alloc() 必须在 getPtr 之前，所以用一个容器存下来
-            size_t offset = allocator.alloc(tensor->getBytes());
-            IT_ASSERT(offset != SIZE_MAX, "Memory allocation failed for tensor");
-            tensorOffsets.emplace_back(offset);
+        // 原地执行：输入在本算子之后不再被使用时，输出直接复用输入的 buffer
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        for (int i = 0; i < nOps; ++i)
+        {
+            auto &op = ops[i];
+            auto attrs = KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            if (op->getOutputs().size() != 1 || !kernelRegistry.hasKernel(attrs) ||
+                !kernelRegistry.getKernel(attrs)->supportInplace())
+                continue;
+            auto output = op->getOutput();
+            size_t out = tensorIndex.at(output.get());
+            for (auto &input : op->getInputs())
+            {
+                size_t in = tensorIndex.at(input.get()), buffer = bufferOf[in];
+                if (!input->getSource() || intervals[buffer].last != i ||
+                    input->getDims() != output->getDims() ||
+                    !(input->getDType() == output->getDType()))
+                    continue;
+                // 其他输入仍会被读取，不能与它们共享 buffer
+                bool shared = false;
+                for (auto &other : op->getInputs())
+                    if (other != input && bufferOf[tensorIndex.at(other.get())] == buffer)
+                        shared = true;
+                if (shared)
+                    continue;
+                mergeInto(bufferOf[out], buffer, bufferOffset[in]);
+                break;
+            }
+        }
+
+        // 零拷贝 concat：拼接的每一块在输出中连续时（拼接维度之前的维度都为 1），
+        // 让产生输入的算子直接写到输出的对应位置，concat 本身不再搬运数据
+        for (int i = 0; i < nOps; ++i)
+        {
+            if (ops[i]->getOpType() != OpType::Concat)
+                continue;
+            auto concat = as<ConcatObj>(ops[i]);
+            auto output = concat->getOutput();
+            auto outDims = output->getDims();
+            if (std::accumulate(outDims.begin(), outDims.begin() + concat->getDim(),
+                                1, std::multiplies<int>()) != 1)
+                continue;
+            size_t outBuffer = bufferOf[tensorIndex.at(output.get())];
+            bool placeable = true;
+            std::unordered_set<size_t> seen{outBuffer};
+            for (auto &input : concat->getInputs())
+            {
+                size_t in = tensorIndex.at(input.get()), buffer = bufferOf[in];
+                // 输入必须由图中算子产生、只被这个 concat 使用，且独占自己的 buffer
+                placeable &= input->getSource() && input->getTargets().size() == 1 &&
+                             bufferOffset[in] == 0 && intervals[buffer].last == i &&
+                             seen.insert(buffer).second;
+            }
+            if (!placeable)
+                continue;
+            size_t offset = bufferOffset[tensorIndex.at(output.get())];
+            for (auto &input : concat->getInputs())
+            {
+                mergeInto(bufferOf[tensorIndex.at(input.get())], outBuffer, offset);
+                offset += input->getBytes();
+            }
         }
 
+        vector<size_t> buffers;
+        vector<MemInterval> bufferIntervals;
+        for (size_t i = 0; i < tensors.size(); ++i)
+            if (bufferAlive[i])
+            {
+                buffers.emplace_back(i);
+                bufferIntervals.emplace_back(intervals[i]);
+            }
+
+        memPlan = MemoryPlanner::plan(bufferIntervals, planMode, allocator);
+        // 离线规划的结果是相对偏移，整体作为一个内存块向 allocator 申请
+        size_t base = 0;
+        if (planMode != MemPlanMode::Online && memPlan.peak > 0)
+            base = allocator.alloc(memPlan.peak);
+        vector<size_t> bufferBase(tensors.size(), 0);
+        for (size_t j = 0; j < buffers.size(); ++j)
+            bufferBase[buffers[j]] = base + memPlan.offsets[j];
+
         auto ptr = allocator.getPtr();
         IT_ASSERT(ptr != nullptr, "Failed to get memory pointer from allocator");
-        
-        for(int i = 0; i < (int)tensors.size(); ++i) {
-            auto blob = make_ref<BlobObj>(runtime, static_cast<char*>(ptr) + tensorOffsets[i]);
+
+        for (size_t i = 0; i < tensors.size(); ++i)
+        {
+            if (tensors[i]->isWeight())
+                continue;
+            size_t offset = bufferBase[bufferOf[i]] + bufferOffset[i];
+            auto blob = make_ref<BlobObj>(runtime, static_cast<char *>(ptr) + offset);
             tensors[i]->setDataBlob(blob);
         }
-       
-        allocator.info();
+
+        // weights 只分配一次且从不释放，已经通过 shareWeights 绑定的跳过
+        bool arenaFixed = weightAllocator->getCapacity() != 0;
+        vector<pair<Tensor, size_t>> weightOffsets;
+        for (auto &tensor : tensors)
+            if (tensor->isWeight() && tensor->data == nullptr)
+                weightOffsets.emplace_back(tensor, weightAllocator->alloc(tensor->getBytes()));
+        IT_ASSERT(weightOffsets.empty() || !arenaFixed,
+                  "Weights cannot be added once the persistent arena is allocated");
+        // kernel 预打包的常量输入也放在持久内存中；持久内存已经分配（共享或重新规划）时
+        // 不再为新的算子预留，它们在运行时照常打包
+        vector<pair<Operator, size_t>> prepackOffsets;
+        for (auto &op : ops)
+        {
+            auto attrs = KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            if (arenaFixed || op->getPrepacked() || !kernelRegistry.hasKernel(attrs))
+                continue;
+            size_t size = kernelRegistry.getKernel(attrs)->getPrepackSize(op);
+            if (size > 0)
+                prepackOffsets.emplace_back(op, weightAllocator->alloc(size));
+        }
+        if (!weightOffsets.empty() || !prepackOffsets.empty())
+        {
+            auto weightPtr = static_cast<char *>(weightAllocator->getPtr());
+            for (auto &[tensor, offset] : weightOffsets)
+                tensor->setDataBlob(make_ref<BlobObj>(runtime, weightPtr + offset));
+            for (auto &[op, offset] : prepackOffsets)
+                op->setPrepacked(make_ref<BlobObj>(runtime, weightPtr + offset));
+            weightsPacked = false;
+        }
+        // 暂存的权重数据写入刚分配的位置，已经不在图中的直接丢弃
+        for (auto &[tensor, bytes] : pendingData)
+            if (tensor->data != nullptr)
+                std::memcpy(tensor->getRawDataPtr<char *>(), bytes.data(), bytes.size());
+        pendingData.clear();
+
+        // 记录每个 tensor 的位置以及每个算子执行时存活的字节数
+        memStats = MemStats{};
+        memStats.planPeak = memPlan.peak;
+        memStats.lowerBound = memPlan.lowerBound;
+        for (size_t i = 0; i < tensors.size(); ++i)
+        {
+            auto &tensor = tensors[i];
+            auto arena = static_cast<char *>(tensor->isWeight() ? weightAllocator->getPtr() : ptr);
+            memStats.tensors.push_back({tensor->getGuid(), tensor->getFuid(), tensor->isWeight(),
+                                        size_t(tensor->getRawDataPtr<char *>() - arena),
+                                        tensor->getBytes(), tensorIntervals[i].first,
+                                        tensorIntervals[i].last});
+        }
+        for (int i = 0; i < nOps; ++i)
+        {
+            size_t live = 0;
+            for (auto &interval : bufferIntervals)
+                if (interval.first <= i && i <= interval.last)
+                    live += interval.size;
+            memStats.timeline.push_back({ops[i]->getGuid(), ops[i]->getOpType(), live});
+        }
+    }
+
+    void GraphObj::prepack()
+    {
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        for (auto &op : ops)
+        {
+            if (!op->getPrepacked())
+                continue;
+            auto attrs = KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            kernelRegistry.getKernel(attrs)->prepack(op, op->getPrepacked()->getPtr<void *>());
+        }
+        weightsPacked = true;
+    }
+
+    MemStats GraphObj::getMemStats() const
+    {
+        MemStats ret = memStats;
+        ret.activation = allocator.getStats();
+        ret.weight = weightAllocator->getStats();
+        return ret;
+    }
+
+    TensorVec GraphObj::getWeights() const
+    {
+        TensorVec ret;
+        for (const auto &t : tensors)
+            if (t->isWeight())
+                ret.emplace_back(t);
+        return ret;
+    }
+
+    void GraphObj::shareWeights(const Graph &other)
+    {
+        auto mine = getWeights(), theirs = other->getWeights();
+        IT_ASSERT(mine.size() == theirs.size(), "Weight count mismatch");
+        for (size_t i = 0; i < mine.size(); ++i)
+        {
+            IT_ASSERT(mine[i]->getDims() == theirs[i]->getDims() &&
+                          mine[i]->getDType() == theirs[i]->getDType(),
+                      "Weight mismatch: " + mine[i]->toString());
+            IT_ASSERT(theirs[i]->data != nullptr, "Weights of the shared graph are not allocated");
+            mine[i]->setDataBlob(theirs[i]->data);
+        }
+        // 持有对方的持久内存，保证共享的 weights 不会先于本图被释放
+        weightAllocator = other->weightAllocator;
     }
 
     Tensor GraphObj::addTensor(Shape dim, DataType dtype)
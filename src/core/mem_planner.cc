@@ -0,0 +1,162 @@
+#include "core/mem_planner.h"
+#include <algorithm>
+#include <numeric>
+
+namespace infini
+{
+    MemPlan MemoryPlanner::plan(const vector<MemInterval> &intervals,
+                                MemPlanMode mode, Allocator &allocator)
+    {
+        MemPlan ret;
+        switch (mode)
+        {
+        case MemPlanMode::Online:
+            ret = replay(intervals, allocator);
+            break;
+        case MemPlanMode::GreedyBySize:
+            ret = greedyBySize(intervals);
+            break;
+        case MemPlanMode::GreedyByBreadth:
+            ret = greedyByBreadth(intervals);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+        ret.lowerBound = lowerBound(intervals);
+        return ret;
+    }
+
+    size_t MemoryPlanner::lowerBound(const vector<MemInterval> &intervals)
+    {
+        int steps = 0;
+        for (auto &interval : intervals)
+            steps = std::max(steps, interval.last + 2);
+        // difference array of live bytes over the steps
+        vector<long long> delta(steps, 0);
+        for (auto &interval : intervals)
+        {
+            delta[interval.first] += interval.size;
+            delta[interval.last + 1] -= interval.size;
+        }
+        long long live = 0, ret = 0;
+        for (auto d : delta)
+            ret = std::max(ret, live += d);
+        return ret;
+    }
+
+    MemPlan MemoryPlanner::replay(const vector<MemInterval> &intervals,
+                                  Allocator &allocator)
+    {
+        int steps = 0;
+        for (auto &interval : intervals)
+            steps = std::max(steps, interval.last + 1);
+        vector<vector<size_t>> allocAt(steps), freeAt(steps);
+        for (size_t i = 0; i < intervals.size(); ++i)
+        {
+            allocAt[intervals[i].first].emplace_back(i);
+            freeAt[intervals[i].last].emplace_back(i);
+        }
+
+        MemPlan ret;
+        ret.offsets.resize(intervals.size());
+        for (int s = 0; s < steps; ++s)
+        {
+            // allocate before freeing, outputs must not overlap inputs of the
+            // same op
+            for (auto i : allocAt[s])
+                ret.offsets[i] = allocator.alloc(intervals[i].size);
+            for (auto i : freeAt[s])
+                allocator.free(ret.offsets[i], intervals[i].size);
+        }
+        ret.peak = allocator.getPeak();
+        return ret;
+    }
+
+    size_t MemoryPlanner::findOffset(const vector<MemInterval> &intervals,
+                                     const vector<size_t> &placed,
+                                     const vector<size_t> &offsets, size_t idx)
+    {
+        vector<pair<size_t, size_t>> conflicts; // (offset, size)
+        for (auto j : placed)
+            if (intervals[j].overlaps(intervals[idx]))
+                conflicts.emplace_back(offsets[j], intervals[j].size);
+        std::sort(conflicts.begin(), conflicts.end());
+
+        size_t size = intervals[idx].size;
+        size_t prevEnd = 0, best = SIZE_MAX, bestGap = SIZE_MAX;
+        for (auto &[offset, sz] : conflicts)
+        {
+            if (offset > prevEnd)
+            {
+                size_t gap = offset - prevEnd;
+                if (gap >= size && gap < bestGap)
+                {
+                    best = prevEnd;
+                    bestGap = gap;
+                }
+            }
+            prevEnd = std::max(prevEnd, offset + sz);
+        }
+        return best != SIZE_MAX ? best : prevEnd;
+    }
+
+    MemPlan MemoryPlanner::greedyBySize(const vector<MemInterval> &intervals)
+    {
+        vector<size_t> order(intervals.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                         { return intervals[a].size > intervals[b].size; });
+
+        MemPlan ret;
+        ret.offsets.resize(intervals.size());
+        vector<size_t> placed;
+        for (auto i : order)
+        {
+            ret.offsets[i] = findOffset(intervals, placed, ret.offsets, i);
+            ret.peak = std::max(ret.peak, ret.offsets[i] + intervals[i].size);
+            placed.emplace_back(i);
+        }
+        return ret;
+    }
+
+    MemPlan MemoryPlanner::greedyByBreadth(const vector<MemInterval> &intervals)
+    {
+        int steps = 0;
+        for (auto &interval : intervals)
+            steps = std::max(steps, interval.last + 1);
+        vector<vector<size_t>> liveAt(steps);
+        vector<size_t> breadth(steps, 0);
+        for (size_t i = 0; i < intervals.size(); ++i)
+            for (int s = intervals[i].first; s <= intervals[i].last; ++s)
+            {
+                liveAt[s].emplace_back(i);
+                breadth[s] += intervals[i].size;
+            }
+        vector<int> stepOrder(steps);
+        std::iota(stepOrder.begin(), stepOrder.end(), 0);
+        std::stable_sort(stepOrder.begin(), stepOrder.end(), [&](int a, int b)
+                         { return breadth[a] > breadth[b]; });
+
+        MemPlan ret;
+        ret.offsets.resize(intervals.size());
+        vector<bool> assigned(intervals.size(), false);
+        vector<size_t> placed;
+        for (auto s : stepOrder)
+        {
+            auto &live = liveAt[s];
+            std::stable_sort(live.begin(), live.end(), [&](size_t a, size_t b)
+                             { return intervals[a].size > intervals[b].size; });
+            for (auto i : live)
+            {
+                if (assigned[i])
+                    continue;
+                ret.offsets[i] = findOffset(intervals, placed, ret.offsets, i);
+                ret.peak = std::max(ret.peak, ret.offsets[i] + intervals[i].size);
+                assigned[i] = true;
+                placed.emplace_back(i);
+            }
+        }
+        return ret;
+    }
+
+} // namespace infini
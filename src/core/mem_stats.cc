@@ -0,0 +1,80 @@
+#include "core/mem_stats.h"
+#include <fstream>
+
+namespace infini
+{
+    static void writeAllocatorStats(std::ostream &os, const AllocatorStats &s)
+    {
+        os << "{\"used\": " << s.used << ", \"peak\": " << s.peak
+           << ", \"freeBlocks\": " << s.freeBlockCount
+           << ", \"largestFreeBlock\": " << s.largestFreeBlock
+           << ", \"fragmentation\": " << s.fragmentation << "}";
+    }
+
+    static void writeJson(std::ostream &os, const MemStats &stats)
+    {
+        os << "{\n";
+        os << "  \"planPeak\": " << stats.planPeak << ",\n";
+        os << "  \"lowerBound\": " << stats.lowerBound << ",\n";
+        os << "  \"activation\": ";
+        writeAllocatorStats(os, stats.activation);
+        os << ",\n  \"weight\": ";
+        writeAllocatorStats(os, stats.weight);
+        os << ",\n  \"tensors\": [";
+        for (size_t i = 0; i < stats.tensors.size(); ++i)
+        {
+            auto &t = stats.tensors[i];
+            os << (i ? ",\n    " : "\n    ");
+            os << "{\"guid\": " << t.guid << ", \"fuid\": " << t.fuid
+               << ", \"weight\": " << (t.weight ? "true" : "false")
+               << ", \"offset\": " << t.offset << ", \"size\": " << t.size
+               << ", \"first\": " << t.first << ", \"last\": " << t.last << "}";
+        }
+        os << "\n  ],\n  \"timeline\": [";
+        for (size_t i = 0; i < stats.timeline.size(); ++i)
+        {
+            auto &op = stats.timeline[i];
+            os << (i ? ",\n    " : "\n    ");
+            os << "{\"step\": " << i << ", \"guid\": " << op.guid
+               << ", \"type\": \"" << op.type.toString()
+               << "\", \"liveBytes\": " << op.liveBytes << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    static void writeCsv(std::ostream &os, const MemStats &stats)
+    {
+        os << "step,guid,type,live_bytes\n";
+        for (size_t i = 0; i < stats.timeline.size(); ++i)
+        {
+            auto &op = stats.timeline[i];
+            os << i << "," << op.guid << "," << op.type.toString() << ","
+               << op.liveBytes << "\n";
+        }
+    }
+
+    void exportMemStats(std::ostream &os, const MemStats &stats,
+                        MemStatsFormat format)
+    {
+        switch (format)
+        {
+        case MemStatsFormat::Json:
+            writeJson(os, stats);
+            break;
+        case MemStatsFormat::Csv:
+            writeCsv(os, stats);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+
+    void exportMemStats(const string &path, const MemStats &stats,
+                        MemStatsFormat format)
+    {
+        std::ofstream ofs(path);
+        IT_ASSERT(ofs.is_open(), "Failed to open " + path);
+        exportMemStats(ofs, stats, format);
+    }
+
+} // namespace infini
@@ -21,6 +21,10 @@ namespace infini
             CASE(Transpose);
             CASE(Concat);
             CASE(MatMul);
+            CASE(MatMulInteger);
+            CASE(QuantizeLinear);
+            CASE(DequantizeLinear);
+            CASE(FusedElementwise);
 
         default:
             return "Unknown";
@@ -1,5 +1,6 @@
 #include "core/operator.h"
 #include "core/graph.h"
+#include <cstring>
 
 namespace infini
 {
@@ -82,4 +83,37 @@ namespace infini
         return inferDataType(inputs);
     }
 
+    Blob OperatorObj::getPrepacked() const
+    {
+        if (!prepacked || prepackKey() != prepackedFor)
+            return nullptr;
+        return prepacked;
+    }
+
+    void OperatorObj::setPrepacked(Blob blob)
+    {
+        prepacked = std::move(blob);
+        prepackedFor = prepacked ? prepackKey() : vector<int>();
+    }
+
+    vector<int> OperatorObj::prepackKey() const
+    {
+        auto key = getOpAttrVector();
+        for (auto &input : inputs)
+        {
+            key.emplace_back(input->getDType().getIndex());
+            key.emplace_back(input->getRank());
+            for (auto d : input->getDims())
+                key.emplace_back(d);
+        }
+        return key;
+    }
+
+    int OperatorObj::floatAttr(float value)
+    {
+        int bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
 } // namespace infini
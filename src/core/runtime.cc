@@ -6,17 +6,30 @@
 #include <chrono>
 #include <cstring>
 #include <memory>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 namespace infini
 {
     void NativeCpuRuntimeObj::run(const Graph &graph) const
+    {
+        run(graph, nullptr);
+    }
+
+    void NativeCpuRuntimeObj::run(const Graph &graph,
+                                  const OpCallback &afterOp) const
     {
         const auto &kernelRegistry = KernelRegistry::getInstance();
+        if (graph->needsPrepack())
+            graph->prepack();
 
         for (auto &op : graph->getOperators())
         {
             auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
             Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
             kernel->compute(op, this);
+            if (afterOp)
+                afterOp(op);
         }
     }
 
@@ -29,8 +42,30 @@ namespace infini
 
     void *NativeCpuRuntimeObj::alloc(size_t size)
     {
-        return calloc((size + sizeof(uint64_t) - 1) / sizeof(uint64_t),
-                      sizeof(uint64_t));
+        constexpr size_t hugePageSize = 2 << 20;
+        size_t align = alignment;
+        bool useHugePage = hugePage && size >= hugePageSize;
+        if (useHugePage)
+            align = std::max(align, hugePageSize);
+        size = (size + align - 1) / align * align;
+
+        void *ptr = nullptr;
+        int err = posix_memalign(&ptr, align, size);
+        IT_ASSERT(err == 0, "Failed to allocate " + std::to_string(size) + " bytes");
+#ifdef __linux__
+        if (useHugePage)
+            madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+        if (zeroFill)
+            memset(ptr, 0, size);
+        return ptr;
+    }
+
+    void NativeCpuRuntimeObj::setAlignment(size_t alignment)
+    {
+        IT_ASSERT(alignment >= sizeof(void *) && (alignment & (alignment - 1)) == 0,
+                  "Alignment must be a power of two");
+        this->alignment = alignment;
     }
 
 } // namespace infini
@@ -2,13 +2,15 @@
 #include "core/blob.h"
 #include "core/operator.h"
 #include "core/runtime.h"
+#include "utils/operator_utils.h"
 #include <cstring>
 #include <numeric>
 
 namespace infini {
 
     TensorObj::TensorObj(Shape shape_, DataType dtype, Runtime runtime)
-        : dim(shape_.size()), dtype(dtype), runtime(runtime), shape(std::move(shape_)),
+        : dim(shape_.size()), dtype(dtype), runtime(runtime), weight(false),
+          constant(false), shape(std::move(shape_)),
           _size(std::accumulate(shape.begin(), shape.end(), 1, std::multiplies{})) {}
 
     string TensorObj::toString() const
@@ -34,6 +36,19 @@ namespace infini {
         return ret;
     }
 
+void TensorObj::setQuantParams(QuantParams params) {
+    IT_ASSERT(!params.scales.empty() &&
+                  params.scales.size() == params.zeroPoints.size(),
+              "Every scale needs a zero point");
+    if (params.perChannel()) {
+        params.axis = get_real_axis(params.axis, getRank());
+        IT_ASSERT(size_t(shape[params.axis]) == params.scales.size(),
+                  "Per-channel scales must match dim " +
+                      std::to_string(params.axis) + " of " + toString());
+    }
+    quant = std::move(params);
+}
+
 void TensorObj::setShape(Shape shape_) {
     shape = shape_;
     size_t size = std::accumulate(shape.begin(), shape.end(), 1,
@@ -0,0 +1,244 @@
+#include "core/kernel.h"
+#include "operators/unary.h"
+#include "utils/cpu_isa.h"
+#include "utils/float16.h"
+#include <cstring>
+#include <limits>
+
+namespace infini
+{
+    namespace
+    {
+        // W lanes of E, or a plain E when W is 1 so that the same
+        // conversion code handles the scalar tail.
+        template <typename E, int W>
+        struct VecOf
+        {
+            typedef E type __attribute__((vector_size(W * sizeof(E))));
+        };
+
+        template <typename E>
+        struct VecOf<E, 1>
+        {
+            using type = E;
+        };
+
+        template <typename E, int W>
+        using Vec = typename VecOf<E, W>::type;
+
+        template <typename VT, typename VF>
+        inline __attribute__((always_inline)) void convertTo(VT &out,
+                                                             const VF &in)
+        {
+            if constexpr (std::is_arithmetic_v<VF>)
+                out = static_cast<VT>(in);
+            else
+                out = __builtin_convertvector(in, VT);
+        }
+
+        // Value conversion, integers narrowing by keeping the low bits like
+        // a C++ cast.
+        template <typename From, typename To>
+        struct PlainCast
+        {
+            template <int W>
+            static void apply(Vec<To, W> &out, const Vec<From, W> &in)
+            {
+                convertTo(out, in);
+            }
+        };
+
+        // Float to integer rounding toward zero, out-of-range values clamp
+        // to the integer range and NaN becomes 0.
+        template <typename To>
+        struct SaturateCast
+        {
+            template <int W>
+            static void apply(Vec<To, W> &out, const Vec<float, W> &in)
+            {
+                using VF = Vec<float, W>;
+                using VT = Vec<To, W>;
+                constexpr float lo = float(std::numeric_limits<To>::min());
+                constexpr float hi = float(std::numeric_limits<To>::max());
+                // From 32 bits on the maximum is not a float: hi rounds up
+                // to a power of two, clamp to the float below and fix the
+                // lanes that reached hi afterwards.
+                constexpr bool exact = sizeof(To) < 4;
+                constexpr float below = exact ? hi : hi * (1 - 0x1p-24f);
+                VF x = in > lo ? in : VF{} + lo;
+                x = x < below ? x : VF{} + below;
+                x = in == in ? x : VF{};
+                convertTo(out, x);
+                if constexpr (!exact)
+                {
+                    VT over;
+                    convertTo(over, in >= hi);
+                    out = over ? VT{} + std::numeric_limits<To>::max() : out;
+                }
+            }
+        };
+
+        using CastRow = void (*)(void *out, const void *in, size_t len);
+
+        // Elements per thread below which splitting the work is not worth it.
+        constexpr size_t TASK_SIZE = 1 << 14;
+
+        /**
+         * @brief Converts a contiguous range W elements at a time, through
+         * memcpy loads and stores, and the tail one by one.
+         */
+        template <typename From, typename To, class Op, int W>
+        inline __attribute__((always_inline)) void
+        castRowImpl(void *out, const void *in, size_t len)
+        {
+            auto dst = static_cast<To *>(out);
+            auto src = static_cast<const From *>(in);
+            size_t i = 0;
+            for (; i + W <= len; i += W)
+            {
+                Vec<From, W> x;
+                Vec<To, W> y;
+                std::memcpy(&x, src + i, sizeof(x));
+                Op::template apply<W>(y, x);
+                std::memcpy(dst + i, &y, sizeof(y));
+            }
+            for (; i < len; ++i)
+                Op::template apply<1>(dst[i], src[i]);
+        }
+
+        template <typename From, typename To, class Op>
+        void castRowScalar(void *out, const void *in, size_t len)
+        {
+            castRowImpl<From, To, Op, 4>(out, in, len);
+        }
+
+#ifdef IT_X86
+        template <typename From, typename To, class Op>
+        IT_TARGET_AVX2 void castRowAvx2(void *out, const void *in, size_t len)
+        {
+            castRowImpl<From, To, Op, 8>(out, in, len);
+        }
+
+        template <typename From, typename To, class Op>
+        IT_TARGET_AVX512 void castRowAvx512(void *out, const void *in,
+                                            size_t len)
+        {
+            castRowImpl<From, To, Op, 16>(out, in, len);
+        }
+#endif
+
+        template <typename From, typename To, class Op>
+        CastRow selectCastRow()
+        {
+#ifdef IT_X86
+            switch (getCpuIsa())
+            {
+            case CpuIsa::AVX512:
+                return castRowAvx512<From, To, Op>;
+            case CpuIsa::AVX2:
+                return castRowAvx2<From, To, Op>;
+            default:
+                break;
+            }
+#endif
+            return castRowScalar<From, To, Op>;
+        }
+
+        template <typename From, typename To, class Op>
+        CastRow getCastRow()
+        {
+            static const CastRow row = selectCastRow<From, To, Op>();
+            return row;
+        }
+
+        // Half-precision storage goes through the shared converters.
+        template <typename From, typename To,
+                  void (*convert)(To *, const From *, size_t)>
+        void halfRow(void *out, const void *in, size_t len)
+        {
+            convert(static_cast<To *>(out), static_cast<const From *>(in),
+                    len);
+        }
+    } // namespace
+
+    class NativeCast : public CpuKernelWithoutConfig
+    {
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            auto op = as<CastObj>(_op);
+            auto input = op->getInputs(0), output = op->getOutput();
+
+            CastRow row;
+            size_t inSize, outSize;
+#define CAST(type, From, To, ...)                           \
+    case CastType::type:                                    \
+        row = getCastRow<From, To, __VA_ARGS__>();          \
+        inSize = sizeof(From), outSize = sizeof(To);        \
+        break
+#define PLAIN(type, From, To) CAST(type, From, To, PlainCast<From, To>)
+#define HALF(type, From, To, convert)                       \
+    case CastType::type:                                    \
+        row = halfRow<From, To, convert>;                   \
+        inSize = sizeof(From), outSize = sizeof(To);        \
+        break
+
+            switch (op->getType())
+            {
+                HALF(Float2Float16, float, uint16_t, convertFloatToFp16);
+                HALF(Float162Float, uint16_t, float, convertFp16ToFloat);
+                HALF(Float2BFloat16, float, uint16_t, convertFloatToBf16);
+                HALF(BFloat162Float, uint16_t, float, convertBf16ToFloat);
+                CAST(Float2Int64, float, int64_t, SaturateCast<int64_t>);
+                CAST(Float2Int32, float, int32_t, SaturateCast<int32_t>);
+                CAST(Float2Int16, float, int16_t, SaturateCast<int16_t>);
+                CAST(Float2Int8, float, int8_t, SaturateCast<int8_t>);
+                PLAIN(Float2Float, float, float);
+                PLAIN(Int322Float, int32_t, float);
+                PLAIN(Int322Int8, int32_t, int8_t);
+                PLAIN(Int322Int16, int32_t, int16_t);
+                PLAIN(Int322Int64, int32_t, int64_t);
+                PLAIN(Int162Float, int16_t, float);
+                PLAIN(Int162Int32, int16_t, int32_t);
+                PLAIN(Int82Float, int8_t, float);
+                PLAIN(Int82Int16, int8_t, int16_t);
+                PLAIN(Int82Int32, int8_t, int32_t);
+                PLAIN(Uint82Float, uint8_t, float);
+                PLAIN(Uint82Int32, uint8_t, int32_t);
+                PLAIN(Uint82Int64, uint8_t, int64_t);
+                PLAIN(Int642Int32, int64_t, int32_t);
+                PLAIN(Int642Uint32, int64_t, uint32_t);
+                PLAIN(Int642Float, int64_t, float);
+                PLAIN(Uint322Int64, uint32_t, int64_t);
+            default:
+                IT_TODO_HALT();
+            }
+#undef HALF
+#undef PLAIN
+#undef CAST
+            IT_ASSERT(input->getDType().getSize() == inSize &&
+                          output->getDType().getSize() == outSize,
+                      "Cast " + op->toString() + " on " +
+                          input->getDType().toString() + " input");
+
+            auto in = input->getRawDataPtr<char *>();
+            auto out = output->getRawDataPtr<char *>();
+            size_t n = output->size();
+            size_t tasks = (n + TASK_SIZE - 1) / TASK_SIZE;
+#pragma omp parallel for schedule(static) if (tasks > 1)
+            for (size_t t = 0; t < tasks; ++t)
+            {
+                size_t begin = t * TASK_SIZE;
+                row(out + begin * outSize, in + begin * inSize,
+                    std::min(TASK_SIZE, n - begin));
+            }
+        }
+
+        // Float2Float is the only cast with matching dtypes, and it reads
+        // each element before writing it.
+        bool supportInplace() const override { return true; }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::Cast, NativeCast, "Cast_CPU");
+
+}; // namespace infini
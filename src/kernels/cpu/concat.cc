@@ -1,43 +1,123 @@
 #include "operators/concat.h"
 #include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace infini {
 
+namespace {
+
+// Bytes of output per task: large enough to amortise the scheduling, small
+// enough to balance threads when there are only a few outer blocks.
+constexpr size_t TASK_BYTES = 1 << 16;
+
+// memcpy with non-temporal stores, so a destination larger than the caches
+// does not evict the sources. The caller fences once the copies are done.
+void streamCopy(void *dst, const void *src, size_t bytes) {
+#ifdef __SSE2__
+    auto d = static_cast<char *>(dst);
+    auto s = static_cast<const char *>(src);
+    size_t head = -reinterpret_cast<uintptr_t>(d) & 15;
+    if (bytes < head + 64) {
+        std::memcpy(d, s, bytes);
+        return;
+    }
+    std::memcpy(d, s, head);
+    size_t i = head;
+    for (; i + 16 <= bytes; i += 16)
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d + i),
+                         _mm_loadu_si128(
+                             reinterpret_cast<const __m128i *>(s + i)));
+    std::memcpy(d + i, s + i, bytes - i);
+#else
+    std::memcpy(dst, src, bytes);
+#endif
+}
+
+void storeFence() {
+#ifdef __SSE2__
+    _mm_sfence();
+#endif
+}
+
+} // namespace
+
 class NaiveConcat : public CpuKernelWithoutConfig {
+    /**
+     * Each outer block of the output is the concatenation of one contiguous
+     * run from every input. The output is cut into equal ranges of bytes and
+     * every range is filled run by run, so writes stay sequential whatever
+     * the shapes are.
+     */
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
         auto op = as<ConcatObj>(_op);
         auto inputs = op->getInputs(), outputs = op->getOutputs();
         auto dim = op->getDim();
         auto output = outputs[0];
-        std::vector<Shape> iDims;
-        for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
         const auto &outDim = output->getDims();
         size_t blockOffsetInner = 1;
         for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
             blockOffsetInner *= outDim[i];
         size_t blockOffset = outDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < inputs.size(); ++i) {
+        size_t outSize = output->size();
+        if (outSize == 0)
+            return;
+        auto outPtr = output->getRawDataPtr<T *>();
+
+        // run of input i: [begin[i], begin[i] + len[i]) of every outer block
+        size_t n = inputs.size();
+        vector<size_t> begin(n), len(n);
+        vector<const T *> src(n);
+        size_t innerOffset = 0;
+        for (size_t i = 0; i < n; ++i) {
             auto input = inputs[i];
-            auto dimOffset = 0;
-            auto iDim = iDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += iDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = iDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= iDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto inSize = input->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
+            size_t localBlockOffset = input->getDims()[dim] * blockOffsetInner;
+            begin[i] = innerOffset;
+            len[i] = localBlockOffset;
+            src[i] = input->getRawDataPtr<T *>();
+            // The memory planner may have placed the input as a sub-view of
+            // the output already, then there is nothing to copy.
+            if (input->size() == localBlockOffset &&
+                src[i] == outPtr + innerOffset)
+                src[i] = nullptr;
+            innerOffset += localBlockOffset;
+        }
+
+        size_t outBytes = outSize * sizeof(T);
+        bool stream = outBytes > getLastLevelCacheSize();
+        size_t taskSize = TASK_BYTES / sizeof(T);
+        size_t tasks = (outSize + taskSize - 1) / taskSize;
+#pragma omp parallel for schedule(static) if (tasks > 1)
+        for (size_t t = 0; t < tasks; ++t) {
+            size_t pos = t * taskSize, end = std::min(outSize, pos + taskSize);
+            size_t outer = pos / blockOffset, r = pos % blockOffset, i = 0;
+            while (r >= begin[i] + len[i])
+                ++i;
+            while (pos < end) {
+                size_t count = std::min(begin[i] + len[i] - r, end - pos);
+                if (src[i]) {
+                    auto from = src[i] + outer * len[i] + (r - begin[i]);
+                    if (stream)
+                        streamCopy(outPtr + pos, from, count * sizeof(T));
+                    else
+                        std::memcpy(outPtr + pos, from, count * sizeof(T));
+                }
+                pos += count;
+                r += count;
+                if (r == blockOffset) {
+                    r = 0;
+                    ++outer;
+                    i = 0;
+                }
+                while (pos < end && r >= begin[i] + len[i])
+                    ++i;
             }
+            if (stream)
+                storeFence();
         }
     }
 
@@ -53,6 +133,10 @@ class NaiveConcat : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+            CASE(10); // DataType::Float16
+            break;
+            CASE(16); // DataType::BFloat16
+            break;
         default:
             IT_TODO_HALT();
         }
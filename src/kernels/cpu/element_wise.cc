@@ -1,33 +1,259 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include "utils/float16.h"
 #include "utils/operator_utils.h"
+#include <cstring>
 
 namespace infini
 {
-    class NativeElementWise : public CpuKernelWithoutConfig
+    namespace
     {
+        // The operations are written once for scalars and SIMD vectors,
+        // which are passed by reference to keep them out of the call ABI.
+        struct AddOp
+        {
+            template <typename V>
+            static void apply(V &out, const V &a, const V &b) { out = a + b; }
+        };
+
+        struct SubOp
+        {
+            template <typename V>
+            static void apply(V &out, const V &a, const V &b) { out = a - b; }
+        };
+
+        struct MulOp
+        {
+            template <typename V>
+            static void apply(V &out, const V &a, const V &b) { out = a * b; }
+        };
+
+        struct DivOp
+        {
+            template <typename V>
+            static void apply(V &out, const V &a, const V &b) { out = a / b; }
+        };
+
+        // How the two operands are laid out along the innermost dim.
+        enum RowPattern
+        {
+            BothContiguous,
+            ScalarB, // b is broadcast along the row
+            ScalarA, // a is broadcast along the row
+        };
+
         template <typename T>
-        static T addCompute(T val0, T val1)
+        using BinaryRow = void (*)(T *out, const T *a, const T *b, size_t len);
+
+        // Work per thread below which splitting it is not worth it.
+        constexpr size_t TASK_SIZE = 1 << 14;
+
+        /**
+         * @brief out[i] = Op(a[i], b[i]) over one row, W elements per SIMD
+         * register. memcpy compiles to unaligned vector loads and stores.
+         */
+        template <typename T, int W, class Op, int P>
+        inline __attribute__((always_inline)) void
+        binaryRowImpl(T *out, const T *a, const T *b, size_t len)
         {
-            return val0 + val1;
+            typedef T Vec __attribute__((vector_size(W * sizeof(T))));
+            Vec va = Vec{} + *a, vb = Vec{} + *b;
+            size_t i = 0;
+            for (; i + W <= len; i += W)
+            {
+                if (P != ScalarA)
+                    std::memcpy(&va, a + i, sizeof(Vec));
+                if (P != ScalarB)
+                    std::memcpy(&vb, b + i, sizeof(Vec));
+                Vec vo;
+                Op::apply(vo, va, vb);
+                std::memcpy(out + i, &vo, sizeof(Vec));
+            }
+            for (; i < len; ++i)
+                Op::apply(out[i], P == ScalarA ? *a : a[i],
+                          P == ScalarB ? *b : b[i]);
         }
 
-        template <typename T>
-        static T subCompute(T val0, T val1)
+        template <typename T, class Op, int P>
+        void binaryRowScalar(T *out, const T *a, const T *b, size_t len)
         {
-            return val0 - val1;
+            binaryRowImpl<T, 16 / sizeof(T), Op, P>(out, a, b, len);
         }
 
-        template <typename T>
-        static T mulCompute(T val0, T val1)
+#ifdef IT_X86
+        template <class Op, int P>
+        IT_TARGET_AVX2 void binaryRowAvx2(float *out, const float *a,
+                                          const float *b, size_t len)
         {
-            return val0 * val1;
+            binaryRowImpl<float, 8, Op, P>(out, a, b, len);
         }
 
+        template <class Op, int P>
+        IT_TARGET_AVX512 void binaryRowAvx512(float *out, const float *a,
+                                              const float *b, size_t len)
+        {
+            binaryRowImpl<float, 16, Op, P>(out, a, b, len);
+        }
+#endif
+
+        // Float rows get the widest variant the CPU supports.
+        template <typename T, class Op, int P>
+        BinaryRow<T> selectBinaryRow()
+        {
+#ifdef IT_X86
+            if constexpr (std::is_same_v<T, float>)
+            {
+                switch (getCpuIsa())
+                {
+                case CpuIsa::AVX512:
+                    return binaryRowAvx512<Op, P>;
+                case CpuIsa::AVX2:
+                    return binaryRowAvx2<Op, P>;
+                default:
+                    break;
+                }
+            }
+#endif
+            return binaryRowScalar<T, Op, P>;
+        }
+
+        template <typename T, class Op>
+        BinaryRow<T> getBinaryRow(int pattern)
+        {
+            static const BinaryRow<T> rows[] = {
+                selectBinaryRow<T, Op, BothContiguous>(),
+                selectBinaryRow<T, Op, ScalarB>(),
+                selectBinaryRow<T, Op, ScalarA>()};
+            return rows[pattern];
+        }
+
+        // Float16 and BFloat16 rows are widened to float a chunk at a time,
+        // computed by the float row and rounded back.
+        template <class Op, int P, bool BF16>
+        void binaryRowHalf(uint16_t *out, const uint16_t *a, const uint16_t *b,
+                           size_t len)
+        {
+            constexpr size_t CHUNK = 256;
+            float fa[CHUNK], fb[CHUNK], fo[CHUNK];
+            auto toFloat = halfToFloatOf(BF16);
+            auto row = getBinaryRow<float, Op>(P);
+            if (P == ScalarA)
+                toFloat(fa, a, 1);
+            if (P == ScalarB)
+                toFloat(fb, b, 1);
+            for (size_t i = 0; i < len; i += CHUNK)
+            {
+                size_t n = std::min(CHUNK, len - i);
+                if (P != ScalarA)
+                    toFloat(fa, a + i, n);
+                if (P != ScalarB)
+                    toFloat(fb, b + i, n);
+                row(fo, fa, fb, n);
+                floatToHalfOf(BF16)(out + i, fo, n);
+            }
+        }
+
+        template <class Op>
+        BinaryRow<uint16_t> getHalfRow(int pattern, bool bf16)
+        {
+            static const BinaryRow<uint16_t> rows[2][3] = {
+                {binaryRowHalf<Op, BothContiguous, false>,
+                 binaryRowHalf<Op, ScalarB, false>,
+                 binaryRowHalf<Op, ScalarA, false>},
+                {binaryRowHalf<Op, BothContiguous, true>,
+                 binaryRowHalf<Op, ScalarB, true>,
+                 binaryRowHalf<Op, ScalarA, true>}};
+            return rows[bf16][pattern];
+        }
+
+        // uint16_t elements are Float16 or BFloat16, the only 16-bit types
+        // the kernel accepts.
+        template <typename T, class Op>
+        BinaryRow<T> getRow(int pattern, DataType dtype)
+        {
+            if constexpr (std::is_same_v<T, uint16_t>)
+                return getHalfRow<Op>(pattern, dtype == DataType::BFloat16);
+            else
+                return getBinaryRow<T, Op>(pattern);
+        }
+    } // namespace
+
+    class NativeElementWise : public CpuKernelWithoutConfig
+    {
+        // Element strides of an input broadcast to `shapeC`, 0 along the
+        // broadcast dims.
+        static Shape broadcastStride(const Shape &shape, const Shape &shapeC)
+        {
+            Shape stride(shapeC.size(), 0);
+            int p = 1;
+            for (int i = shape.size() - 1, j = shapeC.size() - 1; i >= 0;
+                 --i, --j)
+            {
+                if (shape[i] != 1)
+                    stride[j] = p;
+                p *= shape[i];
+            }
+            return stride;
+        }
+
+        /**
+         * @brief Run `row` over the innermost of the merged `dims`. Short
+         * rows are grouped and long rows are cut so that every task holds
+         * about TASK_SIZE elements; a task locates its first row once and
+         * then advances the index incrementally.
+         */
         template <typename T>
-        static T divCompute(T val0, T val1)
+        static void forEachRow(BinaryRow<T> row, const Shape &dims,
+                               const Shape &sa, const Shape &sb, const T *a,
+                               const T *b, T *out)
         {
-            return (T)(val0 / val1);
+            int outerRank = dims.size() - 1;
+            size_t len = dims.back();
+            int innerA = sa.back(), innerB = sb.back();
+            size_t rows = 1;
+            for (int d = 0; d < outerRank; ++d)
+                rows *= dims[d];
+            if (rows * len == 0)
+                return;
+            size_t rowsPerTask = std::max<size_t>(1, TASK_SIZE / len);
+            size_t segLen = std::min(len, TASK_SIZE);
+            size_t segsPerRow = (len + segLen - 1) / segLen;
+            size_t tasks = (rows + rowsPerTask - 1) / rowsPerTask * segsPerRow;
+
+#pragma omp parallel for schedule(static) if (tasks > 1)
+            for (size_t t = 0; t < tasks; ++t)
+            {
+                size_t r0 = t / segsPerRow * rowsPerTask;
+                size_t r1 = std::min(rows, r0 + rowsPerTask);
+                size_t s0 = t % segsPerRow * segLen;
+                size_t sl = std::min(segLen, len - s0);
+
+                Shape index(outerRank, 0);
+                size_t offsetA = s0 * innerA, offsetB = s0 * innerB;
+                size_t rest = r0;
+                for (int d = outerRank - 1; d >= 0; --d)
+                {
+                    index[d] = rest % dims[d];
+                    rest /= dims[d];
+                    offsetA += (size_t)index[d] * sa[d];
+                    offsetB += (size_t)index[d] * sb[d];
+                }
+                for (size_t r = r0; r < r1; ++r)
+                {
+                    row(out + r * len + s0, a + offsetA, b + offsetB, sl);
+                    for (int d = outerRank - 1; d >= 0; --d)
+                    {
+                        offsetA += sa[d];
+                        offsetB += sb[d];
+                        if (++index[d] < dims[d])
+                            break;
+                        offsetA -= (size_t)sa[d] * dims[d];
+                        offsetB -= (size_t)sb[d] * dims[d];
+                        index[d] = 0;
+                    }
+                }
+            }
         }
 
         template <typename T>
@@ -38,58 +264,60 @@ namespace infini
             T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-            auto shapeA = op->getInputs(0)->getDims();
-            auto shapeB = op->getInputs(1)->getDims();
             auto shapeC = op->getOutput()->getDims();
-            auto rank = op->getOutput()->getRank();
-            Shape a(rank, 1);
-            Shape b(rank, 1);
-            std::copy(shapeA.begin(), shapeA.end(),
-                      a.begin() + (rank - shapeA.size()));
-            std::copy(shapeB.begin(), shapeB.end(),
-                      b.begin() + (rank - shapeB.size()));
-            auto getStride = [&](const Shape &shape)
+            auto strideA = broadcastStride(op->getInputs(0)->getDims(), shapeC);
+            auto strideB = broadcastStride(op->getInputs(1)->getDims(), shapeC);
+
+            // Merge adjacent dims wherever both inputs stay linear across
+            // them. Same-shape and scalar operands collapse to a single dim,
+            // row and column broadcasts to two.
+            Shape dims, sa, sb;
+            for (size_t i = 0; i < shapeC.size(); ++i)
             {
-                int p = 1;
-                Shape stride(rank);
-                for (auto i = rank; i > 0; --i)
+                if (shapeC[i] == 1)
+                    continue;
+                if (!dims.empty() && sa.back() == strideA[i] * shapeC[i] &&
+                    sb.back() == strideB[i] * shapeC[i])
                 {
-                    stride[i - 1] = p;
-                    p = p * shape[i - 1];
+                    dims.back() *= shapeC[i];
+                    sa.back() = strideA[i];
+                    sb.back() = strideB[i];
+                    continue;
                 }
-                return stride;
-            };
-            Shape strideA = getStride(a);
-            Shape strideB = getStride(b);
-
-            auto n = op->getOutput()->size();
-            T (*_doCompute)
-            (T val0, T val1);
+                dims.push_back(shapeC[i]);
+                sa.push_back(strideA[i]);
+                sb.push_back(strideB[i]);
+            }
+            if (dims.empty())
+            {
+                dims = {1};
+                sa = sb = {0};
+            }
+
+            // The innermost stride of each input is 1, or 0 when it is
+            // broadcast along that dim.
+            int pattern = sa.back() && sb.back() ? BothContiguous
+                          : sa.back()            ? ScalarB
+                                                 : ScalarA;
+            BinaryRow<T> row;
             switch (op->getOpType().underlying())
             {
             case OpType::Add:
-                _doCompute = addCompute<T>;
+                row = getRow<T, AddOp>(pattern, op->getDType());
                 break;
             case OpType::Sub:
-                _doCompute = subCompute<T>;
+                row = getRow<T, SubOp>(pattern, op->getDType());
                 break;
             case OpType::Mul:
-                _doCompute = mulCompute<T>;
+                row = getRow<T, MulOp>(pattern, op->getDType());
                 break;
             case OpType::Div:
-                _doCompute = divCompute<T>;
+                row = getRow<T, DivOp>(pattern, op->getDType());
                 break;
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t i = 0; i < n; ++i)
-            {
-                auto shapeIndexC = locate_index(i, shapeC);
-                auto indexA = delocate_index(shapeIndexC, a, strideA);
-                auto indexB = delocate_index(shapeIndexC, b, strideB);
-                outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
-            }
+            forEachRow(row, dims, sa, sb, inptr0, inptr1, outptr);
         }
 
         void compute(const Operator &_op,
@@ -106,10 +334,19 @@ namespace infini
                 break;
                 CASE(12); // DataType::UInt32
                 break;
+                CASE(10); // DataType::Float16
+                break;
+                CASE(16); // DataType::BFloat16
+                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        // The output may alias an input of the same shape: element i of that
+        // input is read before outptr[i] is written, and the other input is
+        // in a different buffer.
+        bool supportInplace() const override { return true; }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
@@ -0,0 +1,219 @@
+#include "operators/fused_element_wise.h"
+#include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Elements per thread below which splitting the work is not worth it.
+constexpr size_t TASK_SIZE = 1 << 14;
+// Elements a program runs over at a time. The intermediate results of a chunk
+// stay in L1, only the inputs and the output go through memory.
+constexpr size_t CHUNK = 512;
+
+// Same semantics as the Add/Sub/Mul/Div, Relu and Clip kernels. Vectors are
+// passed by reference to keep them out of the call ABI.
+struct AddOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        out = a + b;
+    }
+};
+
+struct SubOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        out = a - b;
+    }
+};
+
+struct MulOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        out = a * b;
+    }
+};
+
+struct DivOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        out = a / b;
+    }
+};
+
+struct ReluOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        V zero{};
+        out = zero < a ? a : zero;
+    }
+};
+
+struct ClipOp {
+    template <typename V>
+    static void apply(V &out, const V &a, const V &b, const V &lo,
+                      const V &hi) {
+        V upper = a > hi ? hi : a;
+        out = a < lo ? lo : upper;
+    }
+};
+
+// One step of the program over `len` contiguous elements.
+using StepRow = void (*)(float *out, const float *a, const float *b,
+                         size_t len, float lo, float hi);
+
+template <int W, class Op>
+inline __attribute__((always_inline)) void
+stepRowImpl(float *out, const float *a, const float *b, size_t len, float lo,
+            float hi) {
+    typedef float Vec __attribute__((vector_size(W * sizeof(float))));
+    Vec vlo = Vec{} + lo, vhi = Vec{} + hi;
+    size_t i = 0;
+    for (; i + W <= len; i += W) {
+        Vec va, vb, vo;
+        std::memcpy(&va, a + i, sizeof(Vec));
+        std::memcpy(&vb, b + i, sizeof(Vec));
+        Op::apply(vo, va, vb, vlo, vhi);
+        std::memcpy(out + i, &vo, sizeof(Vec));
+    }
+    for (; i < len; ++i)
+        Op::apply(out[i], a[i], b[i], lo, hi);
+}
+
+template <class Op>
+void stepRowScalar(float *out, const float *a, const float *b, size_t len,
+                   float lo, float hi) {
+    stepRowImpl<4, Op>(out, a, b, len, lo, hi);
+}
+
+#ifdef IT_X86
+template <class Op>
+IT_TARGET_AVX2 void stepRowAvx2(float *out, const float *a, const float *b,
+                                size_t len, float lo, float hi) {
+    stepRowImpl<8, Op>(out, a, b, len, lo, hi);
+}
+
+template <class Op>
+IT_TARGET_AVX512 void stepRowAvx512(float *out, const float *a,
+                                    const float *b, size_t len, float lo,
+                                    float hi) {
+    stepRowImpl<16, Op>(out, a, b, len, lo, hi);
+}
+#endif
+
+template <class Op> StepRow selectStepRow() {
+#ifdef IT_X86
+    switch (getCpuIsa()) {
+    case CpuIsa::AVX512:
+        return stepRowAvx512<Op>;
+    case CpuIsa::AVX2:
+        return stepRowAvx2<Op>;
+    default:
+        break;
+    }
+#endif
+    return stepRowScalar<Op>;
+}
+
+struct StepRows {
+    StepRow add, sub, mul, div, relu, clip;
+};
+
+StepRow getStepRow(OpType type) {
+    static const StepRows rows{
+        selectStepRow<AddOp>(),  selectStepRow<SubOp>(),
+        selectStepRow<MulOp>(),  selectStepRow<DivOp>(),
+        selectStepRow<ReluOp>(), selectStepRow<ClipOp>()};
+    switch (type.underlying()) {
+    case OpType::Add:
+        return rows.add;
+    case OpType::Sub:
+        return rows.sub;
+    case OpType::Mul:
+        return rows.mul;
+    case OpType::Div:
+        return rows.div;
+    case OpType::Relu:
+        return rows.relu;
+    case OpType::Clip:
+        return rows.clip;
+    default:
+        IT_TODO_HALT();
+        return nullptr;
+    }
+}
+
+} // namespace
+
+class NativeFusedElementwise : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<FusedElementwiseObj>(_op);
+        if (!(op->getDType() == DataType::Float32))
+            IT_TODO_HALT();
+        const auto &program = op->getProgram();
+        size_t nInputs = op->numInputs(), nSlots = nInputs + program.size();
+        size_t n = op->getOutput()->size();
+        float *out = op->getOutput()->getRawDataPtr<float *>();
+        vector<const float *> inputs;
+        vector<bool> broadcast;
+        for (auto &input : op->getInputs()) {
+            inputs.emplace_back(input->getRawDataPtr<float *>());
+            broadcast.emplace_back(input->size() == 1);
+        }
+        vector<StepRow> rows;
+        for (auto &instr : program)
+            rows.emplace_back(getStepRow(instr.type));
+
+        size_t tasks = (n + TASK_SIZE - 1) / TASK_SIZE;
+#pragma omp parallel if (tasks > 1)
+        {
+            // a chunk per slot: single-element inputs are broadcast into
+            // theirs once, steps but the last write to theirs
+            vector<float> scratch(nSlots * CHUNK);
+            vector<const float *> slots(nSlots);
+            for (size_t i = 0; i < nInputs; ++i)
+                if (broadcast[i])
+                    std::fill_n(scratch.begin() + i * CHUNK, CHUNK,
+                                inputs[i][0]);
+#pragma omp for schedule(static)
+            for (size_t t = 0; t < tasks; ++t) {
+                size_t end = std::min(n, (t + 1) * TASK_SIZE);
+                for (size_t begin = t * TASK_SIZE; begin < end;
+                     begin += CHUNK) {
+                    size_t len = std::min(CHUNK, end - begin);
+                    for (size_t i = 0; i < nInputs; ++i)
+                        slots[i] = broadcast[i] ? scratch.data() + i * CHUNK
+                                                : inputs[i] + begin;
+                    // the last step writes the output, after every read of
+                    // this chunk, so the output may alias an input
+                    for (size_t s = 0; s < program.size(); ++s) {
+                        auto &instr = program[s];
+                        float *dst = s + 1 == program.size()
+                                         ? out + begin
+                                         : scratch.data() +
+                                               (nInputs + s) * CHUNK;
+                        rows[s](dst, slots[instr.a], slots[instr.b], len,
+                                instr.lo, instr.hi);
+                        slots[nInputs + s] = dst;
+                    }
+                }
+            }
+        }
+    }
+
+    // Reads offset i before writing offset i, see Kernel::supportInplace.
+    bool supportInplace() const override { return true; }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::FusedElementwise, NativeFusedElementwise,
+                "FusedElementwise_CPU");
+
+} // namespace infini
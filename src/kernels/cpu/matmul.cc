@@ -0,0 +1,1013 @@
+#include "operators/matmul.h"
+#include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include "utils/float16.h"
+#include "utils/operator_utils.h"
+#include <cstring>
+#include <type_traits>
+
+namespace infini
+{
+    namespace
+    {
+        // Register tile of the micro-kernel. A row of NR floats is one
+        // AVX-512 register or two AVX2 registers, so MR rows of accumulators
+        // plus the B row and the broadcast A value fit the register file.
+        constexpr int MR = 6;
+        constexpr int NR = 16;
+        // Cache blocking: a KC x NR panel of packed B stays in L1, an
+        // MC x KC block of packed A in L2 and a KC x NC block of packed B in
+        // L3.
+        constexpr int MC = 96;
+        constexpr int KC = 256;
+        constexpr int NC = 2048;
+
+        // Batched matrices with no dim above this skip packing.
+        constexpr int SMALL_DIM = 128;
+
+        // Work below which spawning threads costs more than it saves.
+        constexpr size_t PARALLEL_FLOPS = 1 << 15;
+
+        // Floats of a half matrix a GEMV thread widens at a time.
+        constexpr int HALF_BLOCK = 1 << 14;
+
+        // Float16 and BFloat16 values are stored as uint16_t. They are
+        // widened as they are packed or loaded into cache-sized buffers, so
+        // accumulation stays in float and the operands are read once.
+        inline float widenValue(float x, bool bf16) { return x; }
+
+        inline float widenValue(uint16_t h, bool bf16)
+        {
+            return bf16 ? bf16ToFloat(h) : fp16ToFloat(h);
+        }
+
+        /**
+         * @brief Bias and activation applied to output values before they
+         * are stored, see MatmulObj. `bias` is indexed by output column and
+         * may be null.
+         */
+        struct Epilogue
+        {
+            const float *bias = nullptr;
+            OpType act = OpType::Unknown;
+            float lo = 0, hi = 0;
+
+            // The same epilogue for outputs starting at column j.
+            Epilogue at(int j) const
+            {
+                return {bias ? bias + j : nullptr, act, lo, hi};
+            }
+        };
+
+        // Same semantics as the Add, Relu and Clip kernels, on a scalar or on
+        // a vector of outputs starting at column j.
+        template <typename V>
+        inline __attribute__((always_inline)) void
+        applyEpilogue(V &x, const Epilogue &ep, int j)
+        {
+            if (ep.bias)
+            {
+                V b;
+                std::memcpy(&b, ep.bias + j, sizeof(V));
+                x += b;
+            }
+            if (ep.act == OpType::Relu)
+            {
+                V zero{};
+                x = zero < x ? x : zero;
+            }
+            else if (ep.act == OpType::Clip)
+            {
+                V lo = V{} + ep.lo, hi = V{} + ep.hi;
+                V upper = x > hi ? hi : x;
+                x = x < lo ? lo : upper;
+            }
+        }
+
+        // The epilogue over `len` stored outputs, output r being in column
+        // j0 + r * colStep.
+        void epilogueRow(float *c, int len, const Epilogue &ep, int j0,
+                         int colStep)
+        {
+            for (int r = 0; r < len; ++r)
+                applyEpilogue(c[r], ep, j0 + r * colStep);
+        }
+
+        using MicroKernel = void (*)(int kc, const float *a, const float *b,
+                                     float *c, int ldc, bool accumulate,
+                                     const Epilogue *ep);
+
+        /**
+         * @brief C[MR x NR] (+)= A[MR x kc] * B[kc x NR], with A packed as
+         * kc columns of MR values and B packed as kc rows of NR values. W is
+         * the number of floats per SIMD register of the calling variant. A
+         * non-null `ep`, whose bias starts at the first column of the tile,
+         * is applied to the accumulators before they are stored.
+         */
+        template <int W>
+        inline __attribute__((always_inline)) void
+        microKernelImpl(int kc, const float *a, const float *b, float *c,
+                        int ldc, bool accumulate, const Epilogue *ep)
+        {
+            typedef float Vec __attribute__((vector_size(W * sizeof(float))));
+            constexpr int NV = NR / W;
+            // memcpy compiles to unaligned vector loads and stores, none of
+            // the buffers is assumed to be aligned to a whole vector.
+            Vec acc[MR][NV] = {};
+            for (int p = 0; p < kc; ++p)
+            {
+                Vec bv[NV];
+#pragma GCC unroll 4
+                for (int v = 0; v < NV; ++v)
+                    std::memcpy(&bv[v], b + p * NR + v * W, sizeof(Vec));
+#pragma GCC unroll 8
+                for (int i = 0; i < MR; ++i)
+                {
+                    float av = a[p * MR + i];
+#pragma GCC unroll 4
+                    for (int v = 0; v < NV; ++v)
+                        acc[i][v] += av * bv[v];
+                }
+            }
+#pragma GCC unroll 8
+            for (int i = 0; i < MR; ++i)
+            {
+#pragma GCC unroll 4
+                for (int v = 0; v < NV; ++v)
+                {
+                    float *dst = c + i * ldc + v * W;
+                    if (accumulate)
+                    {
+                        Vec cv;
+                        std::memcpy(&cv, dst, sizeof(Vec));
+                        acc[i][v] += cv;
+                    }
+                    if (ep)
+                        applyEpilogue(acc[i][v], *ep, v * W);
+                    std::memcpy(dst, &acc[i][v], sizeof(Vec));
+                }
+            }
+        }
+
+        /**
+         * @brief y[r] = dot(mat[r, 0:cols], x) for every row r < rows, rows
+         * being `ld` floats apart.
+         */
+        template <int W>
+        inline __attribute__((always_inline)) void
+        gemvDotImpl(const float *mat, int64_t ld, int rows, int cols,
+                    const float *x, float *y)
+        {
+            typedef float Vec __attribute__((vector_size(W * sizeof(float))));
+            for (int r = 0; r < rows; ++r)
+            {
+                const float *row = mat + r * ld;
+                // independent accumulators hide the FMA latency
+                Vec acc[4] = {};
+                int j = 0;
+                for (; j + 4 * W <= cols; j += 4 * W)
+#pragma GCC unroll 4
+                    for (int v = 0; v < 4; ++v)
+                    {
+                        Vec mv, xv;
+                        std::memcpy(&mv, row + j + v * W, sizeof(Vec));
+                        std::memcpy(&xv, x + j + v * W, sizeof(Vec));
+                        acc[v] += mv * xv;
+                    }
+                for (; j + W <= cols; j += W)
+                {
+                    Vec mv, xv;
+                    std::memcpy(&mv, row + j, sizeof(Vec));
+                    std::memcpy(&xv, x + j, sizeof(Vec));
+                    acc[0] += mv * xv;
+                }
+                Vec sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+                float lanes[W], ret = 0;
+                std::memcpy(lanes, &sum, sizeof(Vec));
+                for (int v = 0; v < W; ++v)
+                    ret += lanes[v];
+                for (; j < cols; ++j)
+                    ret += row[j] * x[j];
+                y[r] = ret;
+            }
+        }
+
+        /**
+         * @brief y[c] = sum over r < rows of x[r] * mat[r, c], for every
+         * column c < cols, rows being `ld` floats apart.
+         */
+        template <int W>
+        inline __attribute__((always_inline)) void
+        gemvAxpyImpl(const float *mat, int64_t ld, int rows, int cols,
+                     const float *x, float *y)
+        {
+            typedef float Vec __attribute__((vector_size(W * sizeof(float))));
+            int c = 0;
+            // a strip of 4 vectors of y stays in registers over all rows
+            for (; c + 4 * W <= cols; c += 4 * W)
+            {
+                Vec acc[4] = {};
+                for (int r = 0; r < rows; ++r)
+#pragma GCC unroll 4
+                    for (int v = 0; v < 4; ++v)
+                    {
+                        Vec mv;
+                        std::memcpy(&mv, mat + r * ld + c + v * W, sizeof(Vec));
+                        acc[v] += x[r] * mv;
+                    }
+                std::memcpy(y + c, acc, sizeof(acc));
+            }
+            for (; c + W <= cols; c += W)
+            {
+                Vec acc = {};
+                for (int r = 0; r < rows; ++r)
+                {
+                    Vec mv;
+                    std::memcpy(&mv, mat + r * ld + c, sizeof(Vec));
+                    acc += x[r] * mv;
+                }
+                std::memcpy(y + c, &acc, sizeof(acc));
+            }
+            for (; c < cols; ++c)
+            {
+                float acc = 0;
+                for (int r = 0; r < rows; ++r)
+                    acc += x[r] * mat[r * ld + c];
+                y[c] = acc;
+            }
+        }
+
+        /**
+         * @brief C[TM x TNV*W] = A[TM x k] * B[k x TNV*W] read in place: A
+         * through its strides, B through rows `ldb` floats apart. The tile
+         * shape is fixed at compile time so the accumulators are registers,
+         * a non-null `ep` is applied to them before they are stored.
+         */
+        template <int W, int TM, int TNV>
+        inline __attribute__((always_inline)) void
+        smallTile(int k, const float *a, int64_t rsA, int64_t csA,
+                  const float *b, int ldb, float *c, int ldc,
+                  const Epilogue *ep)
+        {
+            typedef float Vec __attribute__((vector_size(W * sizeof(float))));
+            Vec acc[TM][TNV] = {};
+            for (int p = 0; p < k; ++p)
+            {
+                Vec bv[TNV];
+#pragma GCC unroll 4
+                for (int v = 0; v < TNV; ++v)
+                    std::memcpy(&bv[v], b + p * ldb + v * W, sizeof(Vec));
+#pragma GCC unroll 4
+                for (int i = 0; i < TM; ++i)
+                {
+                    float av = a[i * rsA + p * csA];
+#pragma GCC unroll 4
+                    for (int v = 0; v < TNV; ++v)
+                        acc[i][v] += av * bv[v];
+                }
+            }
+#pragma GCC unroll 4
+            for (int i = 0; i < TM; ++i)
+            {
+                if (ep)
+#pragma GCC unroll 4
+                    for (int v = 0; v < TNV; ++v)
+                        applyEpilogue(acc[i][v], *ep, v * W);
+                std::memcpy(c + i * ldc, acc[i], sizeof(acc[i]));
+            }
+        }
+
+        // Tiles of TM rows, then the leftover rows one at a time.
+        template <int W, int TM, int TNV>
+        inline __attribute__((always_inline)) void
+        smallColumnStrip(int m, int k, const float *a, int64_t rsA,
+                         int64_t csA, const float *b, int ldb, float *c,
+                         int ldc, const Epilogue *ep)
+        {
+            int i = 0;
+            for (; i + TM <= m; i += TM)
+                smallTile<W, TM, TNV>(k, a + i * rsA, rsA, csA, b, ldb,
+                                      c + i * ldc, ldc, ep);
+            for (; i < m; ++i)
+                smallTile<W, 1, TNV>(k, a + i * rsA, rsA, csA, b, ldb,
+                                     c + i * ldc, ldc, ep);
+        }
+
+        /**
+         * @brief C[m x n] = A[m x k] * B[k x n] for one small matrix, B and
+         * C row-major, without packing, followed by `ep` unless it is null.
+         */
+        template <int W>
+        inline __attribute__((always_inline)) void
+        smallGemmImpl(int m, int n, int k, const float *a, int64_t rsA,
+                      int64_t csA, const float *b, float *c,
+                      const Epilogue *ep)
+        {
+            int j = 0;
+            for (; j + 2 * W <= n; j += 2 * W)
+            {
+                Epilogue strip = ep ? ep->at(j) : Epilogue{};
+                smallColumnStrip<W, 4, 2>(m, k, a, rsA, csA, b + j, n, c + j,
+                                          n, ep ? &strip : nullptr);
+            }
+            for (; j + W <= n; j += W)
+            {
+                Epilogue strip = ep ? ep->at(j) : Epilogue{};
+                smallColumnStrip<W, 4, 1>(m, k, a, rsA, csA, b + j, n, c + j,
+                                          n, ep ? &strip : nullptr);
+            }
+            for (; j < n; ++j)
+                for (int i = 0; i < m; ++i)
+                {
+                    float acc = 0;
+                    for (int p = 0; p < k; ++p)
+                        acc += a[i * rsA + p * csA] * b[p * n + j];
+                    if (ep)
+                        applyEpilogue(acc, *ep, j);
+                    c[i * n + j] = acc;
+                }
+        }
+
+        using GemvKernel = void (*)(const float *mat, int64_t ld, int rows,
+                                    int cols, const float *x, float *y);
+        using SmallGemmKernel = void (*)(int m, int n, int k, const float *a,
+                                         int64_t rsA, int64_t csA,
+                                         const float *b, float *c,
+                                         const Epilogue *ep);
+
+        // One variant of every SIMD kernel, for the ISA picked at runtime.
+        struct SgemmKernels
+        {
+            MicroKernel micro;
+            GemvKernel gemvDot;
+            GemvKernel gemvAxpy;
+            SmallGemmKernel small;
+        };
+
+        void microKernelScalar(int kc, const float *a, const float *b,
+                               float *c, int ldc, bool accumulate,
+                               const Epilogue *ep)
+        {
+            microKernelImpl<4>(kc, a, b, c, ldc, accumulate, ep);
+        }
+
+        void gemvDotScalar(const float *mat, int64_t ld, int rows, int cols,
+                           const float *x, float *y)
+        {
+            gemvDotImpl<4>(mat, ld, rows, cols, x, y);
+        }
+
+        void gemvAxpyScalar(const float *mat, int64_t ld, int rows, int cols,
+                            const float *x, float *y)
+        {
+            gemvAxpyImpl<4>(mat, ld, rows, cols, x, y);
+        }
+
+        void smallGemmScalar(int m, int n, int k, const float *a,
+                             int64_t rsA, int64_t csA, const float *b,
+                             float *c, const Epilogue *ep)
+        {
+            smallGemmImpl<4>(m, n, k, a, rsA, csA, b, c, ep);
+        }
+
+#ifdef IT_X86
+        IT_TARGET_AVX2 void microKernelAvx2(int kc, const float *a,
+                                            const float *b, float *c, int ldc,
+                                            bool accumulate,
+                                            const Epilogue *ep)
+        {
+            microKernelImpl<8>(kc, a, b, c, ldc, accumulate, ep);
+        }
+
+        IT_TARGET_AVX2 void gemvDotAvx2(const float *mat, int64_t ld,
+                                        int rows, int cols, const float *x,
+                                        float *y)
+        {
+            gemvDotImpl<8>(mat, ld, rows, cols, x, y);
+        }
+
+        IT_TARGET_AVX2 void gemvAxpyAvx2(const float *mat, int64_t ld,
+                                         int rows, int cols, const float *x,
+                                         float *y)
+        {
+            gemvAxpyImpl<8>(mat, ld, rows, cols, x, y);
+        }
+
+        IT_TARGET_AVX2 void smallGemmAvx2(int m, int n, int k,
+                                          const float *a, int64_t rsA,
+                                          int64_t csA, const float *b,
+                                          float *c, const Epilogue *ep)
+        {
+            smallGemmImpl<8>(m, n, k, a, rsA, csA, b, c, ep);
+        }
+
+        IT_TARGET_AVX512 void microKernelAvx512(int kc, const float *a,
+                                                const float *b, float *c,
+                                                int ldc, bool accumulate,
+                                                const Epilogue *ep)
+        {
+            microKernelImpl<16>(kc, a, b, c, ldc, accumulate, ep);
+        }
+
+        IT_TARGET_AVX512 void gemvDotAvx512(const float *mat, int64_t ld,
+                                            int rows, int cols, const float *x,
+                                            float *y)
+        {
+            gemvDotImpl<16>(mat, ld, rows, cols, x, y);
+        }
+
+        IT_TARGET_AVX512 void gemvAxpyAvx512(const float *mat, int64_t ld,
+                                             int rows, int cols,
+                                             const float *x, float *y)
+        {
+            gemvAxpyImpl<16>(mat, ld, rows, cols, x, y);
+        }
+
+        IT_TARGET_AVX512 void smallGemmAvx512(int m, int n, int k,
+                                              const float *a, int64_t rsA,
+                                              int64_t csA, const float *b,
+                                              float *c, const Epilogue *ep)
+        {
+            smallGemmImpl<16>(m, n, k, a, rsA, csA, b, c, ep);
+        }
+#endif
+
+        SgemmKernels selectKernels()
+        {
+            switch (getCpuIsa())
+            {
+#ifdef IT_X86
+            case CpuIsa::AVX512:
+                return {microKernelAvx512, gemvDotAvx512, gemvAxpyAvx512,
+                        smallGemmAvx512};
+            case CpuIsa::AVX2:
+                return {microKernelAvx2, gemvDotAvx2, gemvAxpyAvx2,
+                        smallGemmAvx2};
+#endif
+            default:
+                return {microKernelScalar, gemvDotScalar, gemvAxpyScalar,
+                        smallGemmScalar};
+            }
+        }
+
+        const SgemmKernels &getKernels()
+        {
+            static const SgemmKernels kernels = selectKernels();
+            return kernels;
+        }
+
+        /**
+         * @brief A row-major matrix view addressed by strides, so that a
+         * transposed operand is read in place. `at` widens half elements.
+         */
+        template <typename T>
+        struct MatrixView
+        {
+            const T *data;
+            int64_t rowStride, colStride;
+            bool bf16 = false; // the storage type of uint16_t elements
+
+            float at(int64_t i, int64_t j) const
+            {
+                return widenValue(data[i * rowStride + j * colStride], bf16);
+            }
+
+            MatrixView block(int64_t i, int64_t j) const
+            {
+                return {data + i * rowStride + j * colStride, rowStride,
+                        colStride, bf16};
+            }
+        };
+
+        int ceilDiv(int a, int b) { return (a + b - 1) / b; }
+
+        // Pack A[mc x kc] into MR-row panels, zero-padding the last one.
+        template <typename T>
+        void packA(const MatrixView<T> &A, int mc, int kc, float *dst,
+                   bool parallel)
+        {
+            int panels = ceilDiv(mc, MR);
+#pragma omp parallel for if (parallel)
+            for (int panel = 0; panel < panels; ++panel)
+            {
+                float *out = dst + (size_t)panel * kc * MR;
+                int i0 = panel * MR, rows = std::min(MR, mc - i0);
+                for (int p = 0; p < kc; ++p)
+                {
+                    for (int i = 0; i < rows; ++i)
+                        out[p * MR + i] = A.at(i0 + i, p);
+                    for (int i = rows; i < MR; ++i)
+                        out[p * MR + i] = 0;
+                }
+            }
+        }
+
+        // Pack B[kc x nc] into NR-column panels, zero-padding the last one.
+        template <typename T>
+        void packB(const MatrixView<T> &B, int kc, int nc, float *dst,
+                   bool parallel)
+        {
+            int panels = ceilDiv(nc, NR);
+#pragma omp parallel for if (parallel)
+            for (int panel = 0; panel < panels; ++panel)
+            {
+                float *out = dst + (size_t)panel * kc * NR;
+                int j0 = panel * NR, cols = std::min(NR, nc - j0);
+                for (int p = 0; p < kc; ++p)
+                {
+                    for (int j = 0; j < cols; ++j)
+                        out[p * NR + j] = B.at(p, j0 + j);
+                    for (int j = cols; j < NR; ++j)
+                        out[p * NR + j] = 0;
+                }
+            }
+        }
+
+        // Floats of B once packed into NR-column panels spanning all of k.
+        size_t prepackedSize(int n, int k)
+        {
+            return (size_t)ceilDiv(n, NR) * NR * k;
+        }
+
+        /**
+         * @brief C[m x n] = A[m x k] * B[k x n], C is row-major with leading
+         * dimension ldc. A non-null `ep` is applied to each tile along with
+         * the last k block, before the tile leaves the registers.
+         *
+         * @param prepackedB B already packed by packB over all of k and n,
+         * or null to pack it block by block here. Panel p of the block at
+         * (pc, jc) starts at (jc / NR + p) * k * NR + pc * NR, which is the
+         * layout the micro-kernel reads.
+         */
+        template <typename T>
+        void sgemm(int m, int n, int k, const MatrixView<T> &A,
+                   const MatrixView<T> &B, float *C, int ldc,
+                   const float *prepackedB = nullptr,
+                   const Epilogue *ep = nullptr)
+        {
+            if (k == 0)
+            {
+                for (int i = 0; i < m; ++i)
+                {
+                    std::fill_n(C + (size_t)i * ldc, n, 0.f);
+                    if (ep)
+                        epilogueRow(C + (size_t)i * ldc, n, *ep, 0, 1);
+                }
+                return;
+            }
+            MicroKernel kernel = getKernels().micro;
+            vector<float> packedA((size_t)ceilDiv(std::min(m, MC), MR) * MR *
+                                  std::min(k, KC));
+            vector<float> packedB(prepackedB ? 0
+                                             : (size_t)ceilDiv(std::min(n, NC), NR) *
+                                                   NR * std::min(k, KC));
+
+            for (int jc = 0; jc < n; jc += NC)
+            {
+                int nc = std::min(NC, n - jc);
+                for (int pc = 0; pc < k; pc += KC)
+                {
+                    int kc = std::min(KC, k - pc);
+                    bool accumulate = pc > 0;
+                    const Epilogue *last = pc + kc == k ? ep : nullptr;
+                    if (!prepackedB)
+                        packB(B.block(pc, jc), kc, nc, packedB.data(),
+                              (size_t)m * nc * kc >= PARALLEL_FLOPS);
+
+                    for (int ic = 0; ic < m; ic += MC)
+                    {
+                        int mc = std::min(MC, m - ic);
+                        bool parallel =
+                            (size_t)mc * nc * kc >= PARALLEL_FLOPS;
+                        packA(A.block(ic, pc), mc, kc, packedA.data(),
+                              parallel);
+
+                        // Tiles sharing a B panel are adjacent, so threads
+                        // working on neighbouring tiles reuse it from L3.
+                        int mTiles = ceilDiv(mc, MR), nTiles = ceilDiv(nc, NR);
+#pragma omp parallel for schedule(static) if (parallel)
+                        for (int t = 0; t < mTiles * nTiles; ++t)
+                        {
+                            int ir = t % mTiles * MR, jr = t / mTiles * NR;
+                            int mr = std::min(MR, mc - ir);
+                            int nr = std::min(NR, nc - jr);
+                            const float *a = packedA.data() + (size_t)ir * kc;
+                            const float *b =
+                                prepackedB ? prepackedB +
+                                                 (size_t)(jc + jr) * k +
+                                                 (size_t)pc * NR
+                                           : packedB.data() + (size_t)jr * kc;
+                            float *c = C + (size_t)(ic + ir) * ldc + jc + jr;
+                            Epilogue tileEp =
+                                last ? last->at(jc + jr) : Epilogue{};
+                            if (mr == MR && nr == NR)
+                            {
+                                kernel(kc, a, b, c, ldc, accumulate,
+                                       last ? &tileEp : nullptr);
+                                continue;
+                            }
+                            float tile[MR * NR];
+                            kernel(kc, a, b, tile, NR, false, nullptr);
+                            for (int i = 0; i < mr; ++i)
+                            {
+                                float *row = c + (size_t)i * ldc;
+                                for (int j = 0; j < nr; ++j)
+                                    row[j] = (accumulate ? row[j] : 0.f) +
+                                             tile[i * NR + j];
+                                if (last)
+                                    epilogueRow(row, nr, tileEp, 0, 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief sgemm on half A, B and C. Each MC x NC block of C is
+         * accumulated in a float buffer and rounded once it is complete, so
+         * no more of C than that is held in float. Unless B is prepacked it
+         * is packed again for every MC rows of A.
+         */
+        void hgemm(int m, int n, int k, const MatrixView<uint16_t> &A,
+                   const MatrixView<uint16_t> &B, uint16_t *C, int ldc,
+                   const float *prepackedB, const Epilogue *ep)
+        {
+            auto fromFloat = floatToHalfOf(A.bf16);
+            vector<float> block((size_t)std::min(m, MC) * std::min(n, NC));
+            for (int ic = 0; ic < m; ic += MC)
+            {
+                int mc = std::min(MC, m - ic);
+                for (int jc = 0; jc < n; jc += NC)
+                {
+                    int nc = std::min(NC, n - jc);
+                    Epilogue blockEp = ep ? ep->at(jc) : Epilogue{};
+                    // panels of the columns from jc on start at jc * k
+                    sgemm(mc, nc, k, A.block(ic, 0), B.block(0, jc),
+                          block.data(), nc,
+                          prepackedB ? prepackedB + (size_t)jc * k : nullptr,
+                          ep ? &blockEp : nullptr);
+#pragma omp parallel for if ((size_t)mc * nc * k >= PARALLEL_FLOPS)
+                    for (int i = 0; i < mc; ++i)
+                        fromFloat(C + (size_t)(ic + i) * ldc + jc,
+                                  block.data() + (size_t)i * nc, nc);
+                }
+            }
+        }
+
+        /**
+         * @brief y = mat * x for a row-major [rows x cols] matrix, streaming
+         * it once. Each thread owns a range of rows and applies `ep`, unless
+         * it is null, to them while they are in L1, y[r] being in output
+         * column r * colStep. A half matrix is widened HALF_BLOCK floats at
+         * a time and the partial dots summed in float.
+         */
+        template <typename T>
+        void sgemvDot(const T *mat, int rows, int cols, const float *x, T *y,
+                      const Epilogue *ep, int colStep, bool bf16 = false)
+        {
+            GemvKernel kernel = getKernels().gemvDot;
+            constexpr int CHUNK = 16, BLOCK_COLS = HALF_BLOCK / CHUNK;
+            constexpr bool half = !std::is_same_v<T, float>;
+            int chunks = ceilDiv(rows, CHUNK);
+#pragma omp parallel if ((size_t)rows * cols >= PARALLEL_FLOPS)
+            {
+                vector<float> wide(half ? HALF_BLOCK : 0);
+#pragma omp for
+                for (int i = 0; i < chunks; ++i)
+                {
+                    int r = i * CHUNK;
+                    int len = std::min(CHUNK, rows - r);
+                    if constexpr (!half)
+                    {
+                        kernel(mat + (size_t)r * cols, cols, len, cols, x,
+                               y + r);
+                        if (ep)
+                            epilogueRow(y + r, len, *ep, r * colStep,
+                                        colStep);
+                    }
+                    else
+                    {
+                        auto toFloat = halfToFloatOf(bf16);
+                        float acc[CHUNK] = {}, part[CHUNK];
+                        for (int c = 0; c < cols; c += BLOCK_COLS)
+                        {
+                            int width = std::min(BLOCK_COLS, cols - c);
+                            for (int q = 0; q < len; ++q)
+                                toFloat(wide.data() + q * width,
+                                        mat + (size_t)(r + q) * cols + c,
+                                        width);
+                            kernel(wide.data(), width, len, width, x + c,
+                                   part);
+                            for (int q = 0; q < len; ++q)
+                                acc[q] += part[q];
+                        }
+                        if (ep)
+                            epilogueRow(acc, len, *ep, r * colStep, colStep);
+                        floatToHalfOf(bf16)(y + r, acc, len);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief y = mat^T * x for a row-major [rows x cols] matrix,
+         * streaming it once. Each thread owns a range of columns and walks
+         * every row of it, then applies `ep` like sgemvDot. A half matrix
+         * is widened HALF_BLOCK floats at a time and the partial sums added
+         * in float.
+         */
+        template <typename T>
+        void sgemvAxpy(const T *mat, int rows, int cols, const float *x, T *y,
+                       const Epilogue *ep, int colStep, bool bf16 = false)
+        {
+            GemvKernel kernel = getKernels().gemvAxpy;
+            constexpr int CHUNK = 256, BLOCK_ROWS = HALF_BLOCK / CHUNK;
+            constexpr bool half = !std::is_same_v<T, float>;
+            int chunks = ceilDiv(cols, CHUNK);
+#pragma omp parallel if ((size_t)rows * cols >= PARALLEL_FLOPS)
+            {
+                vector<float> wide(half ? HALF_BLOCK : 0);
+#pragma omp for
+                for (int i = 0; i < chunks; ++i)
+                {
+                    int c = i * CHUNK;
+                    int len = std::min(CHUNK, cols - c);
+                    if constexpr (!half)
+                    {
+                        kernel(mat + c, cols, rows, len, x, y + c);
+                        if (ep)
+                            epilogueRow(y + c, len, *ep, c * colStep,
+                                        colStep);
+                    }
+                    else
+                    {
+                        auto toFloat = halfToFloatOf(bf16);
+                        float acc[CHUNK] = {}, part[CHUNK];
+                        for (int r = 0; r < rows; r += BLOCK_ROWS)
+                        {
+                            int height = std::min(BLOCK_ROWS, rows - r);
+                            for (int q = 0; q < height; ++q)
+                                toFloat(wide.data() + q * len,
+                                        mat + (size_t)(r + q) * cols + c,
+                                        len);
+                            kernel(wide.data(), len, height, len, x + r,
+                                   part);
+                            for (int q = 0; q < len; ++q)
+                                acc[q] += part[q];
+                        }
+                        if (ep)
+                            epilogueRow(acc, len, *ep, c * colStep, colStep);
+                        floatToHalfOf(bf16)(y + c, acc, len);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Many small GEMMs sharing m/n/k, one per output batch, with
+         * the operands of batch i at a + offsetA[i] and b + offsetB[i].
+         * Threads split the batch; a transposed B is copied to a per-thread
+         * k x n buffer that stays in L1, everything else is read in place.
+         * `ep` is applied to every matrix unless it is null. Half matrices
+         * are widened to per-thread buffers and the product is rounded back
+         * once it is complete.
+         */
+        template <typename T>
+        void batchedSmallSgemm(int m, int n, int k, const T *a,
+                               const vector<size_t> &offsetA, int64_t rsA,
+                               int64_t csA, const T *b,
+                               const vector<size_t> &offsetB, bool transB,
+                               T *c, const Epilogue *ep, bool bf16 = false)
+        {
+            SmallGemmKernel kernel = getKernels().small;
+            constexpr bool half = !std::is_same_v<T, float>;
+            int batch = offsetA.size();
+#pragma omp parallel if ((size_t)batch * m * n * k >= PARALLEL_FLOPS)
+            {
+                vector<float> bt(transB ? (size_t)k * n : 0);
+                vector<float> wa(half ? (size_t)m * k : 0),
+                    wb(half ? (size_t)k * n : 0), wc(half ? (size_t)m * n : 0);
+#pragma omp for schedule(static)
+                for (int i = 0; i < batch; ++i)
+                {
+                    const float *ai, *bi;
+                    float *ci;
+                    if constexpr (half)
+                    {
+                        auto toFloat = halfToFloatOf(bf16);
+                        toFloat(wa.data(), a + offsetA[i], wa.size());
+                        toFloat(wb.data(), b + offsetB[i], wb.size());
+                        ai = wa.data(), bi = wb.data(), ci = wc.data();
+                    }
+                    else
+                    {
+                        ai = a + offsetA[i], bi = b + offsetB[i];
+                        ci = c + (size_t)i * m * n;
+                    }
+                    if (transB)
+                    {
+                        for (int p = 0; p < k; ++p)
+                            for (int j = 0; j < n; ++j)
+                                bt[p * n + j] = bi[j * k + p];
+                        bi = bt.data();
+                    }
+                    kernel(m, n, k, ai, rsA, csA, bi, ci, ep);
+                    if constexpr (half)
+                        floatToHalfOf(bf16)(c + (size_t)i * m * n, wc.data(),
+                                            wc.size());
+                }
+            }
+        }
+    } // namespace
+
+    class NativeMatmul : public CpuKernelWithoutConfig
+    {
+        enum class Path
+        {
+            Gemv,         // m or n is 1
+            BatchedSmall, // many small matrices, split across the batch
+            Blocked,      // packed GEMM per matrix
+        };
+
+        static Path choosePath(const Ref<MatmulObj> &op)
+        {
+            int m = op->getM(), n = op->getN(), k = op->getK();
+            auto dims = op->getOutput()->getDims();
+            size_t batch = 1;
+            for (size_t i = 0; i + 2 < dims.size(); ++i)
+                batch *= dims[i];
+            if (batch > 1 && m <= SMALL_DIM && n <= SMALL_DIM && k <= SMALL_DIM)
+                return Path::BatchedSmall;
+            if (m == 1 || n == 1)
+                return Path::Gemv;
+            return Path::Blocked;
+        }
+
+        // Number of distinct B matrices, each packed on its own.
+        static size_t matricesOf(const Tensor &t)
+        {
+            auto dims = t->getDims();
+            size_t ret = 1;
+            for (size_t i = 0; i + 2 < dims.size(); ++i)
+                ret *= dims[i];
+            return ret;
+        }
+
+        static bool isHalf(DataType dtype)
+        {
+            return dtype == DataType::Float16 || dtype == DataType::BFloat16;
+        }
+
+        // b is only read when packed is null. T is float, or uint16_t for
+        // Float16 (bf16 false) and BFloat16 (bf16 true).
+        template <typename T>
+        static void computeAs(const Ref<MatmulObj> &op, Path path, const T *a,
+                              const T *b, T *c, const float *packed,
+                              const Epilogue *ep, bool bf16)
+        {
+            constexpr bool half = !std::is_same_v<T, float>;
+            auto A = op->getInputs(0), B = op->getInputs(1);
+            auto C = op->getOutput();
+            int m = op->getM(), n = op->getN(), k = op->getK();
+            auto offsetA = batch_offsets(A->getDims(), C->getDims());
+            auto offsetB = batch_offsets(B->getDims(), C->getDims());
+
+            // transA reads A as [k, m] and transB reads B as [n, k]
+            int64_t rsA = op->getTransA() ? 1 : k;
+            int64_t csA = op->getTransA() ? m : 1;
+            int64_t rsB = op->getTransB() ? 1 : n;
+            int64_t csB = op->getTransB() ? k : 1;
+            if (path == Path::BatchedSmall)
+            {
+                batchedSmallSgemm(m, n, k, a, offsetA, rsA, csA, b, offsetB,
+                                  op->getTransB(), c, ep, bf16);
+                return;
+            }
+            // the vector operand of a half GEMV, widened whole
+            vector<float> wideVec(half && path == Path::Gemv ? k : 0);
+            for (size_t i = 0; i < offsetA.size(); ++i)
+            {
+                const T *ai = a + offsetA[i];
+                const T *bi = packed ? nullptr : b + offsetB[i];
+                T *ci = c + i * m * n;
+                if (path == Path::Blocked)
+                {
+                    MatrixView<T> viewA{ai, rsA, csA, bf16},
+                        viewB{bi, rsB, csB, bf16};
+                    const float *packedB =
+                        packed ? packed + offsetB[i] / ((size_t)k * n) *
+                                              prepackedSize(n, k)
+                               : nullptr;
+                    if constexpr (half)
+                        hgemm(m, n, k, viewA, viewB, ci, n, packedB, ep);
+                    else
+                        sgemm(m, n, k, viewA, viewB, ci, n, packedB, ep);
+                    continue;
+                }
+                // A vector operand is contiguous whatever its transpose flag,
+                // the matrix one is streamed in its stored layout without
+                // packing. With m = 1 the outputs are the columns, with n = 1
+                // they all are in column 0.
+                auto vec = [&](const T *v) -> const float *
+                {
+                    if constexpr (half)
+                    {
+                        halfToFloatOf(bf16)(wideVec.data(), v, k);
+                        return wideVec.data();
+                    }
+                    else
+                        return v;
+                };
+                if (m == 1 && op->getTransB())
+                    sgemvDot(bi, n, k, vec(ai), ci, ep, 1, bf16);
+                else if (m == 1)
+                    sgemvAxpy(bi, k, n, vec(ai), ci, ep, 1, bf16);
+                else if (!op->getTransA())
+                    sgemvDot(ai, m, k, vec(bi), ci, ep, 0, bf16);
+                else
+                    sgemvAxpy(ai, k, m, vec(bi), ci, ep, 0, bf16);
+            }
+        }
+
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
+        {
+            auto op = as<MatmulObj>(_op);
+            bool half = isHalf(op->getDType());
+            IT_ASSERT(op->getDType() == DataType::Float32 || half);
+            auto A = op->getInputs(0), B = op->getInputs(1);
+            auto C = op->getOutput();
+            auto path = choosePath(op);
+            auto prepacked = op->getPrepacked();
+            const float *packed = prepacked && path == Path::Blocked
+                                      ? prepacked->getPtr<float *>()
+                                      : nullptr;
+            // the bias and activation folded into the matmul, if any
+            auto bias = op->getBias();
+            bool bf16 = op->getDType() == DataType::BFloat16;
+            vector<float> wideBias(half && bias ? bias->size() : 0);
+            if (!wideBias.empty())
+                halfToFloatOf(bf16)(wideBias.data(),
+                                    bias->getRawDataPtr<uint16_t *>(),
+                                    wideBias.size());
+            Epilogue epilogue{bias ? half ? wideBias.data()
+                                          : bias->getRawDataPtr<float *>()
+                                   : nullptr,
+                              op->getAct(), op->getActMin(), op->getActMax()};
+            const Epilogue *ep =
+                bias || !(op->getAct() == OpType::Unknown) ? &epilogue
+                                                           : nullptr;
+            if (half)
+                computeAs(op, path, A->getRawDataPtr<uint16_t *>(),
+                          B->getRawDataPtr<uint16_t *>(),
+                          C->getRawDataPtr<uint16_t *>(), packed, ep, bf16);
+            else
+                computeAs(op, path, A->getRawDataPtr<float *>(),
+                          B->getRawDataPtr<float *>(),
+                          C->getRawDataPtr<float *>(), packed, ep, false);
+        }
+
+        // A constant B is packed once, with transB folded in, for the
+        // blocked path.
+        size_t getPrepackSize(const Operator &_op) const override
+        {
+            auto op = as<MatmulObj>(_op);
+            auto B = op->getInputs(1);
+            if (!B->isWeight() ||
+                !(op->getDType() == DataType::Float32 ||
+                  isHalf(op->getDType())) ||
+                choosePath(op) != Path::Blocked || op->getK() == 0)
+                return 0;
+            return prepackedSize(op->getN(), op->getK()) * matricesOf(B) *
+                   sizeof(float);
+        }
+
+        void prepack(const Operator &_op, void *dst) const override
+        {
+            auto op = as<MatmulObj>(_op);
+            auto B = op->getInputs(1);
+            int n = op->getN(), k = op->getK();
+            int64_t rsB = op->getTransB() ? 1 : n;
+            int64_t csB = op->getTransB() ? k : 1;
+            float *packed = static_cast<float *>(dst);
+            // half weights are packed as float, widened as they are packed
+            auto packAll = [&](auto *b, bool bf16)
+            {
+                for (size_t i = 0; i < matricesOf(B); ++i)
+                    packB(MatrixView<std::remove_pointer_t<decltype(b)>>{
+                              b + i * k * n, rsB, csB, bf16},
+                          k, n, packed + i * prepackedSize(n, k),
+                          (size_t)k * n >= PARALLEL_FLOPS);
+            };
+            if (isHalf(B->getDType()))
+                packAll(B->getRawDataPtr<uint16_t *>(),
+                        B->getDType() == DataType::BFloat16);
+            else
+                packAll(B->getRawDataPtr<float *>(), false);
+        }
+    };
+
+    REGISTER_KERNEL(Device::CPU, OpType::MatMul, NativeMatmul,
+                    "matmulSgemm_CPU");
+}; // namespace infini
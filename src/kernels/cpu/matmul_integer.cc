@@ -0,0 +1,309 @@
+#include "core/kernel.h"
+#include "operators/matmul.h"
+#include "utils/cpu_isa.h"
+#include "utils/operator_utils.h"
+#include <cstring>
+#ifdef IT_X86
+#include <immintrin.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+// Register tile of the micro-kernel: MR rows of NR int32 accumulators, one
+// AVX-512 register or two AVX2 registers per row.
+constexpr int MR = 4;
+constexpr int NR = 16;
+// Consecutive k values multiplied and summed into one int32 lane.
+constexpr int KG = 4;
+
+// Work below which spawning threads costs more than it saves.
+constexpr size_t PARALLEL_OPS = 1 << 15;
+
+int ceilDiv(int a, int b) { return (a + b - 1) / b; }
+int roundUp(int a, int b) { return ceilDiv(a, b) * b; }
+
+/*
+ * Packed operands. A is stored as unsigned bytes a + 128, in blocks of MR
+ * rows of kp = roundUp(k, KG) bytes. B is stored as NR-column panels of
+ * kp / KG groups, group g holding for each column j of the panel the KG values
+ * b[KG * g ... KG * g + KG - 1][j] next to each other, which is the operand
+ * layout of vpdpbusd. B is zero-padded, so the padding of A never counts.
+ * The +128 bias is removed afterwards with the column sums of B.
+ */
+using MicroKernel = void (*)(int groups, const uint8_t *a, int lda,
+                             const int8_t *b, int32_t *c);
+
+// c[MR x NR] = A[MR x kp] * B[kp x NR] with c row-major, NR per row.
+void microScalar(int groups, const uint8_t *a, int lda, const int8_t *b,
+                 int32_t *c) {
+    int32_t acc[MR][NR] = {};
+    for (int g = 0; g < groups; ++g, b += NR * KG)
+        for (int i = 0; i < MR; ++i)
+            for (int j = 0; j < NR; ++j)
+                for (int t = 0; t < KG; ++t)
+                    acc[i][j] += int32_t(a[i * lda + g * KG + t]) *
+                                 int32_t(b[j * KG + t]);
+    std::memcpy(c, acc, sizeof(acc));
+}
+
+#ifdef IT_X86
+// vpmaddubsw saturates the sum of two u8 x s8 products at int16, which
+// full-range int8 operands reach, so AVX2 widens both sides to int16 and uses
+// vpmaddwd instead. Each 16 bytes of a group are 4 columns of KG values; the
+// product with the KG values of A leaves two partial sums per column, added
+// pairwise at the end.
+IT_TARGET_AVX2 void microAvx2(int groups, const uint8_t *a, int lda,
+                              const int8_t *b, int32_t *c) {
+    for (int h = 0; h < NR; h += 8) {
+        __m256i acc[MR][2];
+        for (int i = 0; i < MR; ++i)
+            acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+        for (int g = 0; g < groups; ++g) {
+            const int8_t *bg = b + g * NR * KG + h * KG;
+            __m256i b0 = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(bg)));
+            __m256i b1 = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(bg + 16)));
+            for (int i = 0; i < MR; ++i) {
+                int32_t a4;
+                std::memcpy(&a4, a + i * lda + g * KG, sizeof(a4));
+                __m256i av = _mm256_cvtepu8_epi16(_mm_set1_epi32(a4));
+                acc[i][0] =
+                    _mm256_add_epi32(acc[i][0], _mm256_madd_epi16(av, b0));
+                acc[i][1] =
+                    _mm256_add_epi32(acc[i][1], _mm256_madd_epi16(av, b1));
+            }
+        }
+        // columns come out as 0 1 4 5 | 2 3 6 7, put them back in order
+        for (int i = 0; i < MR; ++i) {
+            __m256i sum = _mm256_hadd_epi32(acc[i][0], acc[i][1]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + i * NR + h),
+                                _mm256_permute4x64_epi64(sum, 0xd8));
+        }
+    }
+}
+
+// One vpdpbusd per row and group: 16 columns x 4 u8 x s8 products summed
+// straight into int32 lanes.
+IT_TARGET_AVX512VNNI void microVnni(int groups, const uint8_t *a, int lda,
+                                    const int8_t *b, int32_t *c) {
+    __m512i acc[MR];
+    for (int i = 0; i < MR; ++i)
+        acc[i] = _mm512_setzero_si512();
+    for (int g = 0; g < groups; ++g) {
+        __m512i bv = _mm512_loadu_si512(b + g * NR * KG);
+        for (int i = 0; i < MR; ++i) {
+            int32_t a4;
+            std::memcpy(&a4, a + i * lda + g * KG, sizeof(a4));
+            acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32(a4), bv);
+        }
+    }
+    for (int i = 0; i < MR; ++i)
+        _mm512_storeu_si512(c + i * NR, acc[i]);
+}
+#endif
+
+MicroKernel selectMicroKernel() {
+#ifdef IT_X86
+    if (hasAvx512Vnni())
+        return microVnni;
+    if (getCpuIsa() != CpuIsa::Scalar)
+        return microAvx2;
+#endif
+    return microScalar;
+}
+
+MicroKernel getMicroKernel() {
+    static const MicroKernel kernel = selectMicroKernel();
+    return kernel;
+}
+
+// A strided view of a row-major matrix, possibly transposed.
+struct MatrixView {
+    const int8_t *data;
+    int64_t rowStride, colStride;
+
+    int8_t at(int64_t i, int64_t j) const {
+        return data[i * rowStride + j * colStride];
+    }
+};
+
+// Bytes of B packed into panels over all of k, followed by its column sums.
+size_t packedSize(int n, int k) {
+    size_t np = roundUp(n, NR);
+    return np * roundUp(k, KG) + np * sizeof(int32_t);
+}
+
+void packA(const MatrixView &A, int m, int k, uint8_t *dst, int32_t *rowSum) {
+    int kp = roundUp(k, KG);
+#pragma omp parallel for if ((size_t)m * k >= PARALLEL_OPS)
+    for (int i = 0; i < m; ++i) {
+        int32_t sum = 0;
+        for (int p = 0; p < k; ++p) {
+            int8_t v = A.at(i, p);
+            dst[(size_t)i * kp + p] = uint8_t(v + 128);
+            sum += v;
+        }
+        std::fill(dst + (size_t)i * kp + k, dst + (size_t)(i + 1) * kp, 0);
+        rowSum[i] = sum;
+    }
+}
+
+// Pack B and write its column sums after the panels, see packedSize.
+void packB(const MatrixView &B, int k, int n, int8_t *dst) {
+    int kp = roundUp(k, KG), panels = ceilDiv(n, NR);
+    auto colSum = reinterpret_cast<int32_t *>(dst + (size_t)panels * NR * kp);
+#pragma omp parallel for if ((size_t)n * k >= PARALLEL_OPS)
+    for (int panel = 0; panel < panels; ++panel) {
+        int8_t *out = dst + (size_t)panel * NR * kp;
+        for (int j = 0; j < NR; ++j) {
+            int col = panel * NR + j;
+            int32_t sum = 0;
+            for (int p = 0; p < kp; ++p) {
+                int8_t v = col < n && p < k ? B.at(p, col) : 0;
+                out[(p / KG * NR + j) * KG + p % KG] = v;
+                sum += v;
+            }
+            colSum[col] = sum;
+        }
+    }
+}
+
+/**
+ * @brief C[m x n] = (A - za) * (B - zb[j]) in int32, with B packed by packB.
+ * Expanding the product, the raw u8 x s8 sums only need the row sums of A
+ * and the column sums of B to be corrected.
+ */
+void igemm(int m, int n, int k, const MatrixView &A, int32_t za,
+           const int8_t *packedB, const vector<int32_t> &zb, int32_t *C) {
+    MicroKernel kernel = getMicroKernel();
+    int kp = roundUp(k, KG);
+    int mTiles = ceilDiv(m, MR), nTiles = ceilDiv(n, NR);
+    vector<uint8_t> packedA((size_t)mTiles * MR * kp);
+    vector<int32_t> rowSum(mTiles * MR);
+    packA(A, m, k, packedA.data(), rowSum.data());
+    auto colSum = reinterpret_cast<const int32_t *>(packedB +
+                                                    (size_t)nTiles * NR * kp);
+
+    // Tiles sharing a B panel are adjacent, so threads working on
+    // neighbouring tiles reuse it from cache.
+#pragma omp parallel for schedule(static)                                      \
+    if ((size_t)m * n * k >= PARALLEL_OPS)
+    for (int t = 0; t < mTiles * nTiles; ++t) {
+        int ir = t % mTiles * MR, jr = t / mTiles * NR;
+        int32_t tile[MR * NR];
+        kernel(kp / KG, packedA.data() + (size_t)ir * kp, kp,
+               packedB + (size_t)jr * kp, tile);
+        for (int i = 0; i < std::min(MR, m - ir); ++i)
+            for (int j = 0; j < std::min(NR, n - jr); ++j) {
+                int col = jr + j;
+                C[(size_t)(ir + i) * n + col] =
+                    tile[i * NR + j] - (128 + za) * colSum[col] -
+                    zb[col] * rowSum[ir + i] + k * za * zb[col];
+            }
+    }
+}
+
+} // namespace
+
+class NativeMatmulInteger : public CpuKernelWithoutConfig {
+    // Number of distinct B matrices, each packed on its own.
+    static size_t matricesOf(const Tensor &t) {
+        auto dims = t->getDims();
+        size_t ret = 1;
+        for (size_t i = 0; i + 2 < dims.size(); ++i)
+            ret *= dims[i];
+        return ret;
+    }
+
+    static MatrixView viewOfB(const Ref<MatmulIntegerObj> &op,
+                              const int8_t *b) {
+        int n = op->getN(), k = op->getK();
+        // transB reads B as [n, k]
+        return {b, op->getTransB() ? 1 : n, op->getTransB() ? k : 1};
+    }
+
+    // Zero point of every output column.
+    static vector<int32_t> zeroPointsOfB(const Ref<MatmulIntegerObj> &op) {
+        auto B = op->getInputs(1);
+        int n = op->getN();
+        if (!B->isQuantized())
+            return vector<int32_t>(n, 0);
+        const auto &params = B->getQuantParams();
+        if (!params.perChannel())
+            return vector<int32_t>(n, params.zeroPoints[0]);
+        int rank = B->getRank();
+        IT_ASSERT(params.axis == (op->getTransB() ? rank - 2 : rank - 1),
+                  "Per-channel B must be quantized along the output columns");
+        return params.zeroPoints;
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<MatmulIntegerObj>(_op);
+        auto A = op->getInputs(0), B = op->getInputs(1);
+        auto C = op->getOutput();
+        int m = op->getM(), n = op->getN(), k = op->getK();
+        int32_t za = 0;
+        if (A->isQuantized()) {
+            IT_ASSERT(!A->getQuantParams().perChannel(),
+                      "A must be quantized per tensor");
+            za = A->getQuantParams().zeroPoints[0];
+        }
+        auto zb = zeroPointsOfB(op);
+
+        auto offsetA = batch_offsets(A->getDims(), C->getDims());
+        auto offsetB = batch_offsets(B->getDims(), C->getDims());
+        auto prepacked = op->getPrepacked();
+        const int8_t *packed = prepacked ? prepacked->getPtr<int8_t *>() : nullptr;
+        vector<int8_t> local(packed ? 0 : packedSize(n, k));
+
+        // transA reads A as [k, m]
+        int64_t rsA = op->getTransA() ? 1 : k;
+        int64_t csA = op->getTransA() ? m : 1;
+        auto a = A->getRawDataPtr<int8_t *>(), b = B->getRawDataPtr<int8_t *>();
+        auto c = C->getRawDataPtr<int32_t *>();
+        for (size_t i = 0; i < offsetA.size(); ++i) {
+            const int8_t *pb;
+            if (packed) {
+                // only packed when k and n are non-zero
+                size_t matrix = offsetB[i] / ((size_t)k * n);
+                pb = packed + matrix * packedSize(n, k);
+            } else {
+                // consecutive batches often share B, pack it once for them
+                if (i == 0 || offsetB[i] != offsetB[i - 1])
+                    packB(viewOfB(op, b + offsetB[i]), k, n, local.data());
+                pb = local.data();
+            }
+            igemm(m, n, k, {a + offsetA[i], rsA, csA}, za, pb, zb,
+                  c + i * m * n);
+        }
+    }
+
+    // A constant B is packed once, with transB folded in.
+    size_t getPrepackSize(const Operator &_op) const override {
+        auto op = as<MatmulIntegerObj>(_op);
+        auto B = op->getInputs(1);
+        if (!B->isWeight() || op->getK() == 0)
+            return 0;
+        return packedSize(op->getN(), op->getK()) * matricesOf(B);
+    }
+
+    void prepack(const Operator &_op, void *dst) const override {
+        auto op = as<MatmulIntegerObj>(_op);
+        auto B = op->getInputs(1);
+        int n = op->getN(), k = op->getK();
+        auto b = B->getRawDataPtr<int8_t *>();
+        auto packed = static_cast<int8_t *>(dst);
+        for (size_t i = 0; i < matricesOf(B); ++i)
+            packB(viewOfB(op, b + i * k * n), k, n,
+                  packed + i * packedSize(n, k));
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::MatMulInteger, NativeMatmulInteger,
+                "MatmulInteger_CPU");
+
+} // namespace infini
@@ -0,0 +1,254 @@
+#include "operators/quantize.h"
+#include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include <cmath>
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Elements per thread below which splitting the work is not worth it.
+constexpr size_t TASK_SIZE = 1 << 14;
+
+// Adding and subtracting 1.5 * 2^23 rounds a float below 2^22 in magnitude to
+// an integer, half to even like nearbyint, in vector code as well.
+constexpr float ROUND_MAGIC = 0x1.8p23f;
+
+template <typename E, int W> struct VecOf {
+    typedef E type __attribute__((vector_size(W * sizeof(E))));
+};
+
+template <typename E> struct VecOf<E, 1> {
+    using type = E;
+};
+
+template <typename E, int W> using Vec = typename VecOf<E, W>::type;
+
+template <typename VT, typename VF>
+inline __attribute__((always_inline)) void convertTo(VT &out, const VF &in) {
+    if constexpr (std::is_arithmetic_v<VF>)
+        out = static_cast<VT>(in);
+    else
+        out = __builtin_convertvector(in, VT);
+}
+
+// W lanes of x / scale, clamped so that adding the zero point stays in int8
+// and rounded. Clamping first is exact since the bounds are integers; NaN
+// ends up at the lower bound. Lanes are passed by reference, vectors passed
+// by value would change the ABI between the ISA variants.
+template <int W>
+inline __attribute__((always_inline)) void
+quantizeLanes(Vec<int8_t, W> &out, const Vec<float, W> &x, float scale,
+              int32_t zeroPoint) {
+    using VF = Vec<float, W>;
+    const float lo = -128.f - zeroPoint, hi = 127.f - zeroPoint;
+    VF v = x / scale;
+    v = v > lo ? v : VF{} + lo;
+    v = v < hi ? v : VF{} + hi;
+    v = (v + ROUND_MAGIC) - ROUND_MAGIC;
+    Vec<int32_t, W> q;
+    convertTo(q, v);
+    q += zeroPoint;
+    convertTo(out, q);
+}
+
+template <typename T, int W>
+inline __attribute__((always_inline)) void
+dequantizeLanes(Vec<float, W> &out, const Vec<T, W> &q, float scale,
+                int32_t zeroPoint) {
+    Vec<int32_t, W> wide;
+    convertTo(wide, q);
+    convertTo(out, wide - zeroPoint);
+    out *= scale;
+}
+
+using QuantizeRow = void (*)(int8_t *dst, const float *src, size_t n,
+                             float scale, int32_t zeroPoint);
+template <typename T>
+using DequantizeRow = void (*)(float *dst, const T *src, size_t n, float scale,
+                               int32_t zeroPoint);
+
+template <int W>
+inline __attribute__((always_inline)) void
+quantizeRowImpl(int8_t *dst, const float *src, size_t n, float scale,
+                int32_t zeroPoint) {
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        Vec<float, W> x;
+        Vec<int8_t, W> q;
+        std::memcpy(&x, src + i, sizeof(x));
+        quantizeLanes<W>(q, x, scale, zeroPoint);
+        std::memcpy(dst + i, &q, sizeof(q));
+    }
+    for (; i < n; ++i)
+        quantizeLanes<1>(dst[i], src[i], scale, zeroPoint);
+}
+
+template <typename T, int W>
+inline __attribute__((always_inline)) void
+dequantizeRowImpl(float *dst, const T *src, size_t n, float scale,
+                  int32_t zeroPoint) {
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        Vec<T, W> q;
+        Vec<float, W> x;
+        std::memcpy(&q, src + i, sizeof(q));
+        dequantizeLanes<T, W>(x, q, scale, zeroPoint);
+        std::memcpy(dst + i, &x, sizeof(x));
+    }
+    for (; i < n; ++i)
+        dequantizeLanes<T, 1>(dst[i], src[i], scale, zeroPoint);
+}
+
+void quantizeRowScalar(int8_t *dst, const float *src, size_t n, float scale,
+                       int32_t zeroPoint) {
+    quantizeRowImpl<4>(dst, src, n, scale, zeroPoint);
+}
+
+template <typename T>
+void dequantizeRowScalar(float *dst, const T *src, size_t n, float scale,
+                         int32_t zeroPoint) {
+    dequantizeRowImpl<T, 4>(dst, src, n, scale, zeroPoint);
+}
+
+#ifdef IT_X86
+IT_TARGET_AVX2 void quantizeRowAvx2(int8_t *dst, const float *src, size_t n,
+                                    float scale, int32_t zeroPoint) {
+    quantizeRowImpl<8>(dst, src, n, scale, zeroPoint);
+}
+
+template <typename T>
+IT_TARGET_AVX2 void dequantizeRowAvx2(float *dst, const T *src, size_t n,
+                                      float scale, int32_t zeroPoint) {
+    dequantizeRowImpl<T, 8>(dst, src, n, scale, zeroPoint);
+}
+
+IT_TARGET_AVX512 void quantizeRowAvx512(int8_t *dst, const float *src,
+                                        size_t n, float scale,
+                                        int32_t zeroPoint) {
+    quantizeRowImpl<16>(dst, src, n, scale, zeroPoint);
+}
+
+template <typename T>
+IT_TARGET_AVX512 void dequantizeRowAvx512(float *dst, const T *src, size_t n,
+                                          float scale, int32_t zeroPoint) {
+    dequantizeRowImpl<T, 16>(dst, src, n, scale, zeroPoint);
+}
+#endif
+
+struct Rows {
+    QuantizeRow quantize;
+    DequantizeRow<int8_t> dequantize8;
+    DequantizeRow<int32_t> dequantize32;
+};
+
+Rows selectRows() {
+#ifdef IT_X86
+    switch (getCpuIsa()) {
+    case CpuIsa::AVX512:
+        return {quantizeRowAvx512, dequantizeRowAvx512<int8_t>,
+                dequantizeRowAvx512<int32_t>};
+    case CpuIsa::AVX2:
+        return {quantizeRowAvx2, dequantizeRowAvx2<int8_t>,
+                dequantizeRowAvx2<int32_t>};
+    default:
+        break;
+    }
+#endif
+    return {quantizeRowScalar, dequantizeRowScalar<int8_t>,
+            dequantizeRowScalar<int32_t>};
+}
+
+const Rows &getRows() {
+    static const Rows rows = selectRows();
+    return rows;
+}
+
+/**
+ * @brief Calls f(begin, len, channel) over runs of elements sharing one scale,
+ * split into tasks run in parallel. With per-channel parameters the channel
+ * of element i is i / inner % channels, inner being the number of elements
+ * after the channel dim.
+ */
+template <typename F>
+void forEachRun(const Shape &dims, const QuantParams &params, F &&f) {
+    size_t n = 1;
+    for (auto d : dims)
+        n *= d;
+    size_t inner = n, channels = 1;
+    if (params.perChannel()) {
+        channels = dims[params.axis];
+        inner = 1;
+        for (size_t d = params.axis + 1; d < dims.size(); ++d)
+            inner *= dims[d];
+    }
+    size_t tasks = (n + TASK_SIZE - 1) / TASK_SIZE;
+#pragma omp parallel for schedule(static) if (tasks > 1)
+    for (size_t t = 0; t < tasks; ++t) {
+        size_t end = std::min(n, (t + 1) * TASK_SIZE);
+        for (size_t i = t * TASK_SIZE; i < end;) {
+            size_t runEnd = std::min(end, (i / inner + 1) * inner);
+            f(i, runEnd - i, i / inner % channels);
+            i = runEnd;
+        }
+    }
+}
+
+} // namespace
+
+class NativeQuantizeLinear : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<QuantizeLinearObj>(_op);
+        const auto &params = op->getParams();
+        auto in = op->getInputs(0)->getRawDataPtr<float *>();
+        auto out = op->getOutput()->getRawDataPtr<int8_t *>();
+        QuantizeRow row = getRows().quantize;
+        forEachRun(op->getOutput()->getDims(), params,
+                   [&](size_t begin, size_t len, size_t c) {
+                       row(out + begin, in + begin, len, params.scales[c],
+                           params.zeroPoints[c]);
+                   });
+    }
+};
+
+class NativeDequantizeLinear : public CpuKernelWithoutConfig {
+    template <typename T>
+    void doCompute(const Operator &_op, DequantizeRow<T> row) const {
+        auto input = _op->getInputs(0);
+        IT_ASSERT(input->isQuantized(),
+                  "Dequantize needs the quantization parameters of " +
+                      input->toString());
+        const auto &params = input->getQuantParams();
+        auto in = input->getRawDataPtr<T *>();
+        auto out = _op->getOutput()->getRawDataPtr<float *>();
+        forEachRun(input->getDims(), params,
+                   [&](size_t begin, size_t len, size_t c) {
+                       row(out + begin, in + begin, len, params.scales[c],
+                           params.zeroPoints[c]);
+                   });
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        int dataTypeIdx = _op->getDType().getIndex();
+        switch (dataTypeIdx) {
+        case 3: // DataType::Int8
+            doCompute<int8_t>(_op, getRows().dequantize8);
+            break;
+        case 6: // DataType::Int32
+            doCompute<int32_t>(_op, getRows().dequantize32);
+            break;
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::QuantizeLinear, NativeQuantizeLinear,
+                "QuantizeLinear_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::DequantizeLinear, NativeDequantizeLinear,
+                "DequantizeLinear_CPU");
+
+} // namespace infini
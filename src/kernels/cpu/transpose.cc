@@ -1,20 +1,182 @@
 #include "operators/transpose.h"
 #include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include <cstring>
+#ifdef IT_X86
+#include <immintrin.h>
+#endif
 
 namespace infini {
 
-inline Shape idx2Pos(const Shape &shape, size_t idx) {
-    Shape pos = Shape(shape.size(), 0);
-    auto rest = idx, curDimId = shape.size() - 1;
-    while (rest > 0) {
-        pos[curDimId] = rest % shape[curDimId];
-        rest /= shape[curDimId];
-        curDimId--;
+namespace {
+
+// Square tiles of TILE x TILE elements: a source and a destination tile of
+// 4-byte elements take 8 KB, well inside L1.
+constexpr int TILE = 32;
+// The tile is moved in MICRO x MICRO blocks transposed in registers.
+constexpr int MICRO = 8;
+// Elements per thread below which splitting the work is not worth it.
+constexpr size_t TASK_SIZE = 1 << 14;
+
+// Walks a set of dims in row-major order, tracking the matching offsets in
+// the source and the destination.
+struct DimWalker {
+    Shape dims;
+    vector<size_t> srcStrides, dstStrides;
+    Shape index;
+    size_t src = 0, dst = 0;
+
+    void seek(size_t idx) {
+        index.assign(dims.size(), 0);
+        src = dst = 0;
+        for (int d = int(dims.size()) - 1; d >= 0; --d) {
+            index[d] = idx % dims[d];
+            idx /= dims[d];
+            src += index[d] * srcStrides[d];
+            dst += index[d] * dstStrides[d];
+        }
+    }
+
+    void next() {
+        for (int d = int(dims.size()) - 1; d >= 0; --d) {
+            src += srcStrides[d];
+            dst += dstStrides[d];
+            if (++index[d] < dims[d])
+                return;
+            src -= srcStrides[d] * dims[d];
+            dst -= dstStrides[d] * dims[d];
+            index[d] = 0;
+        }
+    }
+};
+
+// dst[j * ldd + i] = src[i * lds + j] for a rows x cols block.
+template <typename T>
+void transposeScalar(const T *src, size_t lds, T *dst, size_t ldd, int rows,
+                     int cols) {
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            dst[j * ldd + i] = src[i * lds + j];
+}
+
+using Micro = void (*)(const void *src, size_t lds, void *dst, size_t ldd);
+
+void microScalar(const void *src, size_t lds, void *dst, size_t ldd) {
+    transposeScalar(static_cast<const uint32_t *>(src), lds,
+                    static_cast<uint32_t *>(dst), ldd, MICRO, MICRO);
+}
+
+#ifdef IT_X86
+// 8x8 block of 4-byte elements transposed in eight AVX registers.
+IT_TARGET_AVX2 void microAvx2(const void *src, size_t lds, void *dst,
+                              size_t ldd) {
+    auto s = static_cast<const float *>(src);
+    auto d = static_cast<float *>(dst);
+    __m256 r[8], t[8];
+    for (int i = 0; i < 8; ++i)
+        r[i] = _mm256_loadu_ps(s + i * lds);
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] =
+            _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] =
+            _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (int i = 0; i < 4; ++i) {
+        _mm256_storeu_ps(d + i * ldd, _mm256_permute2f128_ps(r[i], r[i + 4],
+                                                             0x20));
+        _mm256_storeu_ps(d + (i + 4) * ldd,
+                         _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+    }
+}
+#endif
+
+Micro getMicro() {
+#ifdef IT_X86
+    if (getCpuIsa() != CpuIsa::Scalar)
+        return microAvx2;
+#endif
+    return microScalar;
+}
+
+// Transpose one tile, through the register micro-kernel where it is full.
+template <typename T>
+void transposeTile(const T *src, size_t lds, T *dst, size_t ldd, int rows,
+                   int cols) {
+    if constexpr (sizeof(T) == 4) {
+        static const Micro micro = getMicro();
+        int fullRows = rows / MICRO * MICRO, fullCols = cols / MICRO * MICRO;
+        for (int i = 0; i < fullRows; i += MICRO)
+            for (int j = 0; j < fullCols; j += MICRO)
+                micro(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+        transposeScalar(src + fullCols, lds, dst + fullCols * ldd, ldd,
+                        fullRows, cols - fullCols);
+        transposeScalar(src + fullRows * lds, lds, dst + fullRows, ldd,
+                        rows - fullRows, cols);
+    } else {
+        transposeScalar(src, lds, dst, ldd, rows, cols);
     }
-    return pos;
 }
 
+} // namespace
+
 class NaiveTranspose : public CpuKernelWithoutConfig {
+    /**
+     * Size-1 dims are dropped and input dims that stay adjacent and in order
+     * in the output are merged, so a transpose is reduced to the fewest dims
+     * that actually move.
+     */
+    static void simplify(const Shape &inDim, const Shape &perm, Shape &dims,
+                         Shape &newPerm) {
+        int rank = inDim.size();
+        // nextKept[d]: the first input dim after d that is not dropped
+        vector<int> nextKept(rank, rank);
+        for (int d = rank - 2; d >= 0; --d)
+            nextKept[d] = inDim[d + 1] != 1 ? d + 1 : nextKept[d + 1];
+        // group[d]: merged dim that input dim d belongs to
+        vector<int> group(rank, -1);
+        int prev = -1;
+        Shape groupDims;
+        vector<int> groupFirst; // first input dim of each merged dim
+        for (int j = 0; j < rank; ++j) {
+            int d = perm[j];
+            if (inDim[d] == 1)
+                continue;
+            if (prev >= 0 && d == nextKept[prev]) {
+                group[d] = group[prev];
+                groupDims[group[d]] *= inDim[d];
+            } else {
+                group[d] = groupDims.size();
+                groupDims.push_back(inDim[d]);
+                groupFirst.push_back(d);
+            }
+            prev = d;
+        }
+        // merged dims are numbered in output order, renumber them in input
+        // order to get the reduced input shape and permutation
+        int n = groupDims.size();
+        vector<int> order(n);
+        for (int g = 0; g < n; ++g)
+            order[g] = g;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return groupFirst[a] < groupFirst[b];
+        });
+        vector<int> rankOf(n);
+        dims.resize(n);
+        for (int i = 0; i < n; ++i) {
+            rankOf[order[i]] = i;
+            dims[i] = groupDims[order[i]];
+        }
+        newPerm.resize(n);
+        for (int g = 0; g < n; ++g)
+            newPerm[g] = rankOf[g];
+    }
+
     template <typename T>
     void doCompute(const Operator &_op, const RuntimeObj *context) const {
         auto op = as<TransposeObj>(_op);
@@ -25,14 +187,102 @@ class NaiveTranspose : public CpuKernelWithoutConfig {
         size_t inSize = inputs[0]->size();
         auto inPtr = inputs[0]->getRawDataPtr<T *>(),
              outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
+        if (inSize == 0)
+            return;
+
+        Shape dims, p;
+        simplify(inDim, perm, dims, p);
+        int rank = dims.size();
+        bool identity = true;
+        for (int j = 0; j < rank; ++j)
+            identity &= p[j] == j;
+        if (identity) {
+            if (inPtr != outPtr)
+                std::memcpy(outPtr, inPtr, inSize * sizeof(T));
+            return;
+        }
+
+        vector<size_t> inStride(rank), outStride(rank), dstStrideOf(rank);
+        inStride[rank - 1] = outStride[rank - 1] = 1;
+        for (int d = rank - 2; d >= 0; --d) {
+            inStride[d] = inStride[d + 1] * dims[d + 1];
+            outStride[d] = outStride[d + 1] * dims[p[d + 1]];
+        }
+        for (int j = 0; j < rank; ++j)
+            dstStrideOf[p[j]] = outStride[j];
+
+        // the input dim that becomes the innermost output dim
+        int q = p[rank - 1];
+        size_t rows = dims[q], cols = dims[rank - 1];
+        size_t ldd = dstStrideOf[rank - 1], lds = inStride[q];
+
+        // Pure 2D transpose and a swap of the last two axes (a batch of 2D
+        // transposes) need no walker over the other dims.
+        if (rank == 2 || (rank == 3 && p[0] == 0)) {
+            size_t batch = rank == 2 ? 1 : dims[0];
+            size_t mat = rows * cols;
+            size_t rowTiles = (rows + TILE - 1) / TILE;
+            size_t colTiles = (cols + TILE - 1) / TILE;
+            size_t tasks = batch * rowTiles * colTiles;
+#pragma omp parallel for schedule(static) if (inSize >= TASK_SIZE)
+            for (size_t t = 0; t < tasks; ++t) {
+                size_t b = t / (rowTiles * colTiles);
+                size_t i = t / colTiles % rowTiles * TILE;
+                size_t j = t % colTiles * TILE;
+                transposeTile(inPtr + b * mat + i * lds + j, lds,
+                              outPtr + b * mat + j * ldd + i, ldd,
+                              int(std::min<size_t>(TILE, rows - i)),
+                              int(std::min<size_t>(TILE, cols - j)));
+            }
+            return;
+        }
+
+        // Every other dim is walked in output order so writes stay
+        // sequential.
+        DimWalker walker;
+        for (int j = 0; j < rank; ++j) {
+            int d = p[j];
+            if (d == q || d == rank - 1)
+                continue;
+            walker.dims.push_back(dims[d]);
+            walker.srcStrides.push_back(inStride[d]);
+            walker.dstStrides.push_back(outStride[j]);
+        }
+        size_t outer = 1;
+        for (auto d : walker.dims)
+            outer *= d;
+
+        if (q == rank - 1) {
+            // the innermost dim does not move: copy whole runs
+            size_t runsPerTask = std::max<size_t>(1, TASK_SIZE / cols);
+            size_t tasks = (outer + runsPerTask - 1) / runsPerTask;
+#pragma omp parallel for schedule(static) firstprivate(walker) if (tasks > 1)
+            for (size_t t = 0; t < tasks; ++t) {
+                size_t begin = t * runsPerTask;
+                size_t end = std::min(outer, begin + runsPerTask);
+                walker.seek(begin);
+                for (size_t o = begin; o < end; ++o, walker.next())
+                    std::memcpy(outPtr + walker.dst, inPtr + walker.src,
+                                cols * sizeof(T));
             }
-            outPtr[outIdx] = inPtr[inIdx];
+            return;
+        }
+
+        // general case: a tiled 2D transpose of (q, last input dim) for
+        // every index of the other dims
+        size_t rowTiles = (rows + TILE - 1) / TILE;
+        size_t colTiles = (cols + TILE - 1) / TILE;
+        size_t tasks = outer * rowTiles * colTiles;
+#pragma omp parallel for schedule(static) firstprivate(walker)                 \
+    if (inSize >= TASK_SIZE)
+        for (size_t t = 0; t < tasks; ++t) {
+            walker.seek(t / (rowTiles * colTiles));
+            size_t i = t / colTiles % rowTiles * TILE;
+            size_t j = t % colTiles * TILE;
+            transposeTile(inPtr + walker.src + i * lds + j, lds,
+                          outPtr + walker.dst + j * ldd + i, ldd,
+                          int(std::min<size_t>(TILE, rows - i)),
+                          int(std::min<size_t>(TILE, cols - j)));
         }
     }
 
@@ -48,6 +298,10 @@ class NaiveTranspose : public CpuKernelWithoutConfig {
             break;
             CASE(12); // DataType::UInt32
             break;
+            CASE(10); // DataType::Float16
+            break;
+            CASE(16); // DataType::BFloat16
+            break;
         default:
             IT_TODO_HALT();
         }
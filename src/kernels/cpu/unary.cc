@@ -1,41 +1,186 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "utils/cpu_isa.h"
+#include "utils/float16.h"
+#include <cstring>
+#include <limits>
 
 namespace infini
 {
-    class NativeUnary : public CpuKernelWithoutConfig
+    namespace
     {
+        // Written once for scalars and SIMD vectors, which are passed by
+        // reference to keep them out of the call ABI.
+        struct ReluOp
+        {
+            // max(0, x), NaN maps to 0 like std::max(T(0), x)
+            template <typename V>
+            static void apply(V &out, const V &x, const V &lo, const V &hi)
+            {
+                V zero{};
+                out = zero < x ? x : zero;
+            }
+        };
+
+        struct ClipOp
+        {
+            // NaN passes through, `lo` wins when lo > hi
+            template <typename V>
+            static void apply(V &out, const V &x, const V &lo, const V &hi)
+            {
+                V upper = x > hi ? hi : x;
+                out = x < lo ? lo : upper;
+            }
+        };
+
+        template <typename T>
+        using UnaryRow = void (*)(T *out, const T *in, size_t len, T lo, T hi);
+
+        // Work per thread below which splitting it is not worth it.
+        constexpr size_t TASK_SIZE = 1 << 14;
+
+        /**
+         * @brief out[i] = Op(in[i]) over a contiguous range, W elements per
+         * SIMD register. memcpy compiles to unaligned vector loads and
+         * stores.
+         */
+        template <typename T, int W, class Op>
+        inline __attribute__((always_inline)) void
+        unaryRowImpl(T *out, const T *in, size_t len, T lo, T hi)
+        {
+            typedef T Vec __attribute__((vector_size(W * sizeof(T))));
+            Vec vlo = Vec{} + lo, vhi = Vec{} + hi;
+            size_t i = 0;
+            for (; i + W <= len; i += W)
+            {
+                Vec vx, vo;
+                std::memcpy(&vx, in + i, sizeof(Vec));
+                Op::apply(vo, vx, vlo, vhi);
+                std::memcpy(out + i, &vo, sizeof(Vec));
+            }
+            for (; i < len; ++i)
+                Op::apply(out[i], in[i], lo, hi);
+        }
+
+        template <typename T, class Op>
+        void unaryRowScalar(T *out, const T *in, size_t len, T lo, T hi)
+        {
+            unaryRowImpl<T, 16 / sizeof(T), Op>(out, in, len, lo, hi);
+        }
+
+#ifdef IT_X86
+        template <class Op>
+        IT_TARGET_AVX2 void unaryRowAvx2(float *out, const float *in,
+                                         size_t len, float lo, float hi)
+        {
+            unaryRowImpl<float, 8, Op>(out, in, len, lo, hi);
+        }
+
+        template <class Op>
+        IT_TARGET_AVX512 void unaryRowAvx512(float *out, const float *in,
+                                             size_t len, float lo, float hi)
+        {
+            unaryRowImpl<float, 16, Op>(out, in, len, lo, hi);
+        }
+#endif
+
+        // Float rows get the widest variant the CPU supports.
+        template <typename T, class Op>
+        UnaryRow<T> selectUnaryRow()
+        {
+#ifdef IT_X86
+            if constexpr (std::is_same_v<T, float>)
+            {
+                switch (getCpuIsa())
+                {
+                case CpuIsa::AVX512:
+                    return unaryRowAvx512<Op>;
+                case CpuIsa::AVX2:
+                    return unaryRowAvx2<Op>;
+                default:
+                    break;
+                }
+            }
+#endif
+            return unaryRowScalar<T, Op>;
+        }
+
+        template <typename T, class Op>
+        UnaryRow<T> getUnaryRow()
+        {
+            static const UnaryRow<T> row = selectUnaryRow<T, Op>();
+            return row;
+        }
+
+        // Float16 and BFloat16 rows, and the bounds, are widened to float a
+        // chunk at a time and rounded back after the float row.
+        template <class Op, bool BF16>
+        void unaryRowHalf(uint16_t *out, const uint16_t *in, size_t len,
+                          uint16_t lo, uint16_t hi)
+        {
+            constexpr size_t CHUNK = 256;
+            float fi[CHUNK], fo[CHUNK], flo, fhi;
+            auto toFloat = halfToFloatOf(BF16);
+            auto row = getUnaryRow<float, Op>();
+            toFloat(&flo, &lo, 1);
+            toFloat(&fhi, &hi, 1);
+            for (size_t i = 0; i < len; i += CHUNK)
+            {
+                size_t n = std::min(CHUNK, len - i);
+                toFloat(fi, in + i, n);
+                row(fo, fi, n, flo, fhi);
+                floatToHalfOf(BF16)(out + i, fo, n);
+            }
+        }
+
+        // uint16_t elements are Float16 or BFloat16, the only 16-bit types
+        // the kernels accept.
+        template <typename T, class Op>
+        UnaryRow<T> getRow(DataType dtype)
+        {
+            if constexpr (std::is_same_v<T, uint16_t>)
+                return dtype == DataType::BFloat16 ? unaryRowHalf<Op, true>
+                                                   : unaryRowHalf<Op, false>;
+            else
+                return getUnaryRow<T, Op>();
+        }
+
+        // Split [0, n) into TASK_SIZE chunks spread over the threads.
         template <typename T>
-        static T reluCompute(T val)
+        void unaryCompute(UnaryRow<T> row, T *out, const T *in, size_t n,
+                          T lo, T hi)
         {
-            return std::max(T(0), val);
+            size_t tasks = (n + TASK_SIZE - 1) / TASK_SIZE;
+#pragma omp parallel for schedule(static) if (tasks > 1)
+            for (size_t t = 0; t < tasks; ++t)
+            {
+                size_t begin = t * TASK_SIZE;
+                row(out + begin, in + begin, std::min(TASK_SIZE, n - begin),
+                    lo, hi);
+            }
         }
+    } // namespace
 
+    class NativeUnary : public CpuKernelWithoutConfig
+    {
         template <typename T>
         void doCompute(const Operator &_op, const RuntimeObj *context) const
         {
             auto op = as<UnaryObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
-
-            auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
 
-            T (*_doCompute)
-            (T val);
+            UnaryRow<T> row;
             switch (op->getOpType().underlying())
             {
             case OpType::Relu:
-                _doCompute = reluCompute<T>;
+                row = getRow<T, ReluOp>(op->getDType());
                 break;
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t offset = 0; offset < n; offset++)
-            {
-                outptr[offset] = _doCompute(inptr[offset]);
-            }
+            unaryCompute<T>(row, outptr, inptr, n, T(0), T(0));
         }
 
         void compute(const Operator &_op,
@@ -52,14 +197,34 @@ namespace infini
                 break;
                 CASE(12); // DataType::UInt32
                 break;
+                CASE(10); // DataType::Float16
+                break;
+                CASE(16); // DataType::BFloat16
+                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        // Reads offset i before writing offset i, see Kernel::supportInplace.
+        bool supportInplace() const override { return true; }
     };
 
     class Clip : public CpuKernelWithoutConfig
     {
+        // A float bound in the range of T, a bound outside of it clips
+        // nothing on that side. Converting it directly would be undefined.
+        template <typename T>
+        static T clampBound(float bound)
+        {
+            // float(max()) may round up past max(), so compare with >=
+            if (bound <= float(std::numeric_limits<T>::lowest()))
+                return std::numeric_limits<T>::lowest();
+            if (bound >= float(std::numeric_limits<T>::max()))
+                return std::numeric_limits<T>::max();
+            return T(bound);
+        }
+
         template <typename T>
         void doCompute(const Operator &_op, const RuntimeObj *context) const
         {
@@ -69,14 +234,27 @@ namespace infini
             auto minValue = op->getMin();
             auto maxValue = op->getMax();
 
-            auto n = op->getOutput()->size();
-            for (size_t offset = 0; offset < n; offset++)
+            // a missing bound never clips
+            T lo, hi;
+            if constexpr (std::is_same_v<T, uint16_t>)
+            {
+                // half bounds, rounded to the storage type like the data
+                const float inf = std::numeric_limits<float>::infinity();
+                float flo = minValue ? *minValue : -inf;
+                float fhi = maxValue ? *maxValue : inf;
+                auto fromFloat =
+                    floatToHalfOf(op->getDType() == DataType::BFloat16);
+                fromFloat(&lo, &flo, 1);
+                fromFloat(&hi, &fhi, 1);
+            }
+            else
             {
-                auto val = *inptr++;
-                *outptr++ = (minValue && val < *minValue)   ? *minValue
-                            : (maxValue && val > *maxValue) ? *maxValue
-                                                            : val;
+                lo = minValue ? clampBound<T>(*minValue) : std::numeric_limits<T>::lowest();
+                hi = maxValue ? clampBound<T>(*maxValue) : std::numeric_limits<T>::max();
             }
+            auto n = op->getOutput()->size();
+            unaryCompute<T>(getRow<T, ClipOp>(op->getDType()), outptr, inptr,
+                            n, lo, hi);
         }
 
         void compute(const Operator &_op,
@@ -93,10 +271,16 @@ namespace infini
                 break;
                 CASE(12); // DataType::UInt32
                 break;
+                CASE(10); // DataType::Float16
+                break;
+                CASE(16); // DataType::BFloat16
+                break;
             default:
                 IT_TODO_HALT();
             }
         }
+
+        bool supportInplace() const override { return true; }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
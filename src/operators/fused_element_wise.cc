@@ -0,0 +1,70 @@
+#include "operators/fused_element_wise.h"
+#include "utils/operator_utils.h"
+
+namespace infini {
+FusedElementwiseObj::FusedElementwiseObj(GraphObj *graph, TensorVec inputs,
+                                         Tensor output,
+                                         vector<FusedInstr> program)
+    : OperatorObj(OpType::FusedElementwise, inputs, {output}),
+      program(std::move(program)) {
+    IT_ASSERT(!this->program.empty());
+    int slots = inputs.size();
+    for (auto &instr : this->program) {
+        bool binary = instr.type == OpType::Add || instr.type == OpType::Sub ||
+                      instr.type == OpType::Mul || instr.type == OpType::Div;
+        IT_ASSERT(binary || instr.type == OpType::Relu ||
+                  instr.type == OpType::Clip);
+        IT_ASSERT(instr.a >= 0 && instr.a < slots);
+        if (binary)
+            IT_ASSERT(instr.b >= 0 && instr.b < slots);
+        else
+            instr.b = instr.a;
+        ++slots;
+    }
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+FusedElementwiseObj::inferShape(const TensorVec &inputs) {
+    Shape dims = inputs[0]->getDims();
+    for (auto &input : inputs)
+        dims = infer_broadcast(dims, input->getDims());
+    size_t size = 1;
+    for (auto d : dims)
+        size *= d;
+    // the kernel only broadcasts single elements
+    for (auto &input : inputs)
+        if (input->size() != 1 && input->size() != size)
+            return std::nullopt;
+    return {{dims}};
+}
+
+std::string FusedElementwiseObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(outputs[0]->getDims()) << ",";
+    os << "program=";
+    for (auto &instr : program) {
+        os << instr.type.toString() << "(" << instr.a;
+        if (instr.type == OpType::Clip)
+            os << ",[" << instr.lo << "," << instr.hi << "]";
+        else if (!(instr.type == OpType::Relu))
+            os << "," << instr.b;
+        os << ");";
+    }
+    os << "input=";
+    for (auto input : inputs)
+        os << input->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> FusedElementwiseObj::getOpAttrVector() const {
+    vector<int> ret{type.underlying()};
+    for (auto &instr : program)
+        ret.insert(ret.end(), {instr.type.underlying(), instr.a, instr.b,
+                               floatAttr(instr.lo), floatAttr(instr.hi)});
+    return ret;
+}
+} // namespace infini
@@ -11,16 +11,63 @@ namespace infini
         IT_ASSERT(checkValid(graph));
     }
 
+    MatmulObj::MatmulObj(OpType type, Tensor A, Tensor B, Tensor C,
+                         bool transA, bool transB)
+        : OperatorObj(type, TensorVec{A, B}, {C}), transA(transA),
+          transB(transB) {}
+
+    MatmulIntegerObj::MatmulIntegerObj(GraphObj *graph, Tensor A, Tensor B,
+                                       Tensor C, bool transA, bool transB)
+        : MatmulObj(OpType::MatMulInteger, A, B, C, transA, transB)
+    {
+        IT_ASSERT(A->getDType() == DataType::Int8 &&
+                  B->getDType() == DataType::Int8);
+        IT_ASSERT(checkValid(graph));
+    }
+
+    string MatmulIntegerObj::toString() const
+    {
+        return "MatmulInteger" + MatmulObj::toString().substr(6);
+    }
+
+    vector<DataType>
+    MatmulIntegerObj::inferDataType(const TensorVec &inputs) const
+    {
+        return {DataType::Int32};
+    }
+
+    void MatmulObj::setAct(OpType act, float actMin, float actMax)
+    {
+        IT_ASSERT(act == OpType::Unknown || act == OpType::Relu ||
+                  act == OpType::Clip);
+        this->act = act;
+        this->actMin = actMin;
+        this->actMax = actMax;
+    }
+
     string MatmulObj::toString() const
     {
         std::ostringstream os;
         os << "Matmul([" << (transA ? "A^T" : "A") << "," << (transB ? "B^T" : "B]")
            << ",A=" << inputs[0]->getGuid()
            << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
-           << ",mnk=[" << m << "," << n << "," << k << "])";
+           << ",mnk=[" << m << "," << n << "," << k << "]";
+        if (auto bias = getBias())
+            os << ",bias=" << bias->getGuid();
+        if (act == OpType::Relu)
+            os << ",act=Relu";
+        else if (act == OpType::Clip)
+            os << ",act=Clip[" << actMin << "," << actMax << "]";
+        os << ")";
         return os.str();
     }
 
+    vector<int> MatmulObj::getOpAttrVector() const
+    {
+        return {type.underlying(), transA, transB, act.underlying(),
+                floatAttr(actMin), floatAttr(actMax)};
+    }
+
     optional<vector<Shape>> MatmulObj::inferShape(const TensorVec &inputs)
     {
         // =================================== 作业 ===================================
@@ -31,7 +78,7 @@ namespace infini
 
         // 检查输入数量
 
-        if (inputs.size() != 2) {
+        if (inputs.size() != 2 && inputs.size() != 3) {
 
             return std::nullopt;
 
@@ -119,6 +166,16 @@ namespace infini
 
         
 
+        // 记录 m/n/k，供 kernel 选择计算路径
+
+        m = A_M;
+
+        n = B_N;
+
+        k = A_K;
+
+        
+
         // 准备输出形状
 
         Shape output_shape;
@@ -153,15 +210,19 @@ namespace infini
 
             
 
-            // 从最前面的维度开始比较（广播是从前面的维度开始的）
+            // batch 维度按右侧对齐比较，与 numpy/ONNX 的广播规则一致
 
             for (size_t i = 0; i < max_batch_dims; ++i) {
 
-                // 计算在各自维度中的索引
+                // 较短的一方在左侧补 1
+
+                size_t A_pad = max_batch_dims - A_batch_dims;
+
+                size_t B_pad = max_batch_dims - B_batch_dims;
 
-                int64_t A_dim = (i < A_batch_dims) ? A_dims[i] : 1;
+                int64_t A_dim = (i >= A_pad) ? A_dims[i - A_pad] : 1;
 
-                int64_t B_dim = (i < B_batch_dims) ? B_dims[i] : 1;
+                int64_t B_dim = (i >= B_pad) ? B_dims[i - B_pad] : 1;
 
                 
 
@@ -199,6 +260,16 @@ namespace infini
 
         
 
+        // bias 每个输出列一个值，广播到输出的每一行
+        if (inputs.size() == 3) {
+            auto bias = inputs[2];
+            if (bias->size() != size_t(B_N) || bias->getRank() == 0 ||
+                bias->getDims().back() != B_N ||
+                bias->getRank() > output_shape.size()) {
+                return std::nullopt;
+            }
+        }
+
         return vector<Shape>{output_shape};        
     }
 
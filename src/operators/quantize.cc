@@ -0,0 +1,74 @@
+#include "operators/quantize.h"
+
+namespace infini {
+QuantizeLinearObj::QuantizeLinearObj(GraphObj *graph, Tensor input,
+                                     Tensor output, QuantParams params)
+    : OperatorObj(OpType::QuantizeLinear, {input}, {output}) {
+    IT_ASSERT(input->getDType() == DataType::Float32);
+    IT_ASSERT(checkValid(graph));
+    outputs[0]->setQuantParams(std::move(params));
+    this->params = outputs[0]->getQuantParams();
+}
+
+optional<vector<Shape>>
+QuantizeLinearObj::inferShape(const TensorVec &inputs) {
+    return {{inputs[0]->getDims()}};
+}
+
+vector<DataType>
+QuantizeLinearObj::inferDataType(const TensorVec &inputs) const {
+    return {DataType::Int8};
+}
+
+std::string QuantizeLinearObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "scales=" << params.scales.size() << ",axis=" << params.axis << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> QuantizeLinearObj::getOpAttrVector() const {
+    vector<int> ret{type.underlying(), params.axis};
+    for (auto scale : params.scales)
+        ret.emplace_back(floatAttr(scale));
+    ret.insert(ret.end(), params.zeroPoints.begin(), params.zeroPoints.end());
+    return ret;
+}
+
+DequantizeLinearObj::DequantizeLinearObj(GraphObj *graph, Tensor input,
+                                         Tensor output)
+    : OperatorObj(OpType::DequantizeLinear, {input}, {output}) {
+    IT_ASSERT(input->getDType() == DataType::Int8 ||
+              input->getDType() == DataType::Int32);
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+DequantizeLinearObj::inferShape(const TensorVec &inputs) {
+    return {{inputs[0]->getDims()}};
+}
+
+vector<DataType>
+DequantizeLinearObj::inferDataType(const TensorVec &inputs) const {
+    return {DataType::Float32};
+}
+
+std::string DequantizeLinearObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+// The parameters are those of the input.
+vector<int> DequantizeLinearObj::getOpAttrVector() const {
+    return {type.underlying()};
+}
+} // namespace infini
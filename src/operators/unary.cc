@@ -25,6 +25,8 @@ namespace infini
         return os.str();
     }
 
+    vector<int> UnaryObj::getOpAttrVector() const { return {type.underlying()}; }
+
     ClipObj::ClipObj(GraphObj *graph, Tensor input, Tensor output,
                      std::optional<float> min, std::optional<float> max)
         : OperatorObj(OpType::Clip, {input}, {output}), minValue(min),
@@ -58,6 +60,12 @@ namespace infini
         return os.str();
     }
 
+    vector<int> ClipObj::getOpAttrVector() const
+    {
+        return {type.underlying(), minValue.has_value(), floatAttr(minValue.value_or(0)),
+                maxValue.has_value(), floatAttr(maxValue.value_or(0))};
+    }
+
     CastObj::CastObj(GraphObj *graph, Tensor input, Tensor output, CastType type)
         : OperatorObj(OpType::Cast, {input}, {output}), castType(type)
     {
@@ -96,6 +104,11 @@ namespace infini
         return os.str();
     }
 
+    vector<int> CastObj::getOpAttrVector() const
+    {
+        return {type.underlying(), static_cast<int>(castType)};
+    }
+
     DataType CastObj::getOutputDataType() const
     {
         switch (castType)
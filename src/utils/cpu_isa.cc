@@ -0,0 +1,74 @@
+#include "utils/cpu_isa.h"
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace infini {
+
+static CpuIsa detectCpuIsa() {
+    CpuIsa isa = CpuIsa::Scalar;
+#ifdef IT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl"))
+        isa = CpuIsa::AVX512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+             __builtin_cpu_supports("f16c"))
+        isa = CpuIsa::AVX2;
+#endif
+    if (const char *env = std::getenv("INFINI_CPU_ISA")) {
+        CpuIsa cap = isa;
+        if (!strcmp(env, "scalar"))
+            cap = CpuIsa::Scalar;
+        else if (!strcmp(env, "avx2"))
+            cap = CpuIsa::AVX2;
+        if (cap < isa)
+            isa = cap;
+    }
+    return isa;
+}
+
+CpuIsa getCpuIsa() {
+    static const CpuIsa isa = detectCpuIsa();
+    return isa;
+}
+
+bool hasAvx512Vnni() {
+#ifdef IT_X86
+    static const bool vnni = getCpuIsa() == CpuIsa::AVX512 &&
+                             __builtin_cpu_supports("avx512vnni");
+    return vnni;
+#else
+    return false;
+#endif
+}
+
+const char *toString(CpuIsa isa) {
+    switch (isa) {
+    case CpuIsa::AVX512:
+        return "avx512";
+    case CpuIsa::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+static size_t detectLastLevelCacheSize() {
+    long size = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size <= 0)
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    // unknown: assume a typical desktop L3
+    return size > 0 ? size_t(size) : size_t(8) << 20;
+}
+
+size_t getLastLevelCacheSize() {
+    static const size_t size = detectLastLevelCacheSize();
+    return size;
+}
+
+} // namespace infini
@@ -0,0 +1,187 @@
+#include "utils/float16.h"
+#include "utils/cpu_isa.h"
+#ifdef IT_X86
+#include <immintrin.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+using ToFloat = void (*)(float *dst, const uint16_t *src, size_t n);
+using FromFloat = void (*)(uint16_t *dst, const float *src, size_t n);
+
+void fp16ToFloatScalar(float *dst, const uint16_t *src, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = fp16ToFloat(src[i]);
+}
+
+void floatToFp16Scalar(uint16_t *dst, const float *src, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = floatToFp16(src[i]);
+}
+
+// Local vector typedefs with a dependent size are not accepted by
+// __builtin_convertvector, member typedefs are.
+template <typename E, int W> struct VecOf {
+    typedef E type __attribute__((vector_size(W * sizeof(E))));
+};
+
+// BFloat16 is the upper half of a float, so W lanes are converted with
+// integer vector ops rounding the same way as floatToBf16.
+template <int W>
+inline __attribute__((always_inline)) void
+bf16ToFloatImpl(float *dst, const uint16_t *src, size_t n) {
+    using VH = typename VecOf<uint16_t, W>::type;
+    using VU = typename VecOf<uint32_t, W>::type;
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        VH h;
+        std::memcpy(&h, src + i, sizeof(h));
+        VU bits = __builtin_convertvector(h, VU) << 16;
+        std::memcpy(dst + i, &bits, sizeof(bits));
+    }
+    for (; i < n; ++i)
+        dst[i] = bf16ToFloat(src[i]);
+}
+
+template <int W>
+inline __attribute__((always_inline)) void
+floatToBf16Impl(uint16_t *dst, const float *src, size_t n) {
+    using VH = typename VecOf<uint16_t, W>::type;
+    using VU = typename VecOf<uint32_t, W>::type;
+    size_t i = 0;
+    for (; i + W <= n; i += W) {
+        VU bits;
+        std::memcpy(&bits, src + i, sizeof(bits));
+        VU rounded = (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+        VU quiet = (bits >> 16) | 0x40;
+        rounded = (bits & 0x7fffffff) > 0x7f800000 ? quiet : rounded;
+        VH h = __builtin_convertvector(rounded, VH);
+        std::memcpy(dst + i, &h, sizeof(h));
+    }
+    for (; i < n; ++i)
+        dst[i] = floatToBf16(src[i]);
+}
+
+void bf16ToFloatScalar(float *dst, const uint16_t *src, size_t n) {
+    bf16ToFloatImpl<4>(dst, src, n);
+}
+
+void floatToBf16Scalar(uint16_t *dst, const float *src, size_t n) {
+    floatToBf16Impl<4>(dst, src, n);
+}
+
+#ifdef IT_X86
+IT_TARGET_AVX2 void fp16ToFloatAvx2(float *dst, const uint16_t *src,
+                                    size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    fp16ToFloatScalar(dst + i, src + i, n - i);
+}
+
+IT_TARGET_AVX2 void floatToFp16Avx2(uint16_t *dst, const float *src,
+                                    size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                         _MM_FROUND_TO_NEAREST_INT));
+    floatToFp16Scalar(dst + i, src + i, n - i);
+}
+
+// The zero-masked forms avoid a false -Wmaybe-uninitialized in the unmasked
+// AVX-512 intrinsics of GCC 12.
+IT_TARGET_AVX512 void fp16ToFloatAvx512(float *dst, const uint16_t *src,
+                                        size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_maskz_cvtph_ps(0xffff, h));
+    }
+    fp16ToFloatAvx2(dst + i, src + i, n - i);
+}
+
+IT_TARGET_AVX512 void floatToFp16Avx512(uint16_t *dst, const float *src,
+                                        size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm512_maskz_cvtps_ph(0xffff, _mm512_loadu_ps(src + i),
+                                          _MM_FROUND_TO_NEAREST_INT);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), h);
+    }
+    floatToFp16Avx2(dst + i, src + i, n - i);
+}
+
+IT_TARGET_AVX2 void bf16ToFloatAvx2(float *dst, const uint16_t *src,
+                                    size_t n) {
+    bf16ToFloatImpl<8>(dst, src, n);
+}
+
+IT_TARGET_AVX2 void floatToBf16Avx2(uint16_t *dst, const float *src,
+                                    size_t n) {
+    floatToBf16Impl<8>(dst, src, n);
+}
+
+IT_TARGET_AVX512 void bf16ToFloatAvx512(float *dst, const uint16_t *src,
+                                        size_t n) {
+    bf16ToFloatImpl<16>(dst, src, n);
+}
+
+IT_TARGET_AVX512 void floatToBf16Avx512(uint16_t *dst, const float *src,
+                                        size_t n) {
+    floatToBf16Impl<16>(dst, src, n);
+}
+#endif
+
+struct Converters {
+    ToFloat fp16ToFloat, bf16ToFloat;
+    FromFloat floatToFp16, floatToBf16;
+};
+
+Converters selectConverters() {
+#ifdef IT_X86
+    switch (getCpuIsa()) {
+    case CpuIsa::AVX512:
+        return {fp16ToFloatAvx512, bf16ToFloatAvx512, floatToFp16Avx512,
+                floatToBf16Avx512};
+    case CpuIsa::AVX2:
+        return {fp16ToFloatAvx2, bf16ToFloatAvx2, floatToFp16Avx2,
+                floatToBf16Avx2};
+    default:
+        break;
+    }
+#endif
+    return {fp16ToFloatScalar, bf16ToFloatScalar, floatToFp16Scalar,
+            floatToBf16Scalar};
+}
+
+const Converters &getConverters() {
+    static const Converters converters = selectConverters();
+    return converters;
+}
+
+} // namespace
+
+void convertFp16ToFloat(float *dst, const uint16_t *src, size_t n) {
+    getConverters().fp16ToFloat(dst, src, n);
+}
+
+void convertFloatToFp16(uint16_t *dst, const float *src, size_t n) {
+    getConverters().floatToFp16(dst, src, n);
+}
+
+void convertBf16ToFloat(float *dst, const uint16_t *src, size_t n) {
+    getConverters().bf16ToFloat(dst, src, n);
+}
+
+void convertFloatToBf16(uint16_t *dst, const float *src, size_t n) {
+    getConverters().floatToBf16(dst, src, n);
+}
+
+} // namespace infini
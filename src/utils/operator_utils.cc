@@ -84,6 +84,31 @@ size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
     return ans;
 }
 
+vector<size_t> batch_offsets(const Shape &dims, const Shape &outDims) {
+    int rank = dims.size(), outBatchRank = outDims.size() - 2;
+    int pad = outBatchRank - (rank - 2);
+    vector<size_t> strides(outBatchRank, 0);
+    size_t stride = (size_t)dims[rank - 1] * dims[rank - 2];
+    for (int i = rank - 3; i >= 0; --i) {
+        if (dims[i] != 1)
+            strides[i + pad] = stride;
+        stride *= dims[i];
+    }
+
+    size_t batch = 1;
+    for (int i = 0; i < outBatchRank; ++i)
+        batch *= outDims[i];
+    vector<size_t> ret(batch, 0);
+    for (size_t b = 0; b < batch; ++b) {
+        size_t rest = b;
+        for (int i = outBatchRank - 1; i >= 0; --i) {
+            ret[b] += rest % outDims[i] * strides[i];
+            rest /= outDims[i];
+        }
+    }
+    return ret;
+}
+
 std::string device_to_str(Device device) {
     std::string deviceStr;
     switch (device) {
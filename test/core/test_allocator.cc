@@ -71,4 +71,54 @@ namespace infini
         EXPECT_EQ(ptr1, ptr2);
     }
 
+    TEST(Allocator, testAllocPolicy)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto run = [&](AllocPolicy policy)
+        {
+            Allocator allocator = Allocator(runtime, policy, 8);
+            // layout: a(64) | sep(8) | b(32) | sep(8)
+            size_t offsetA = allocator.alloc(64);
+            allocator.alloc(8);
+            size_t offsetB = allocator.alloc(32);
+            allocator.alloc(8);
+            allocator.free(offsetA, 64);
+            allocator.free(offsetB, 32);
+            return std::make_tuple(offsetA, offsetB, allocator.alloc(24));
+        };
+        // first-fit takes the lowest block, best-fit the tightest one
+        auto [a1, b1, firstFit] = run(AllocPolicy::FirstFit);
+        EXPECT_EQ(firstFit, a1);
+        auto [a2, b2, bestFit] = run(AllocPolicy::BestFit);
+        EXPECT_EQ(bestFit, b2);
+    }
+
+    TEST(Allocator, testAlignment)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        size_t offsetA = allocator.alloc(4);
+        size_t offsetB = allocator.alloc(100);
+        size_t offsetC = allocator.alloc(8);
+        EXPECT_EQ(offsetB - offsetA, DEFAULT_ALIGNMENT);
+        EXPECT_EQ(offsetC - offsetB, 2 * DEFAULT_ALIGNMENT);
+        auto ptr = reinterpret_cast<uintptr_t>(allocator.getPtr());
+        EXPECT_EQ(ptr % DEFAULT_ALIGNMENT, 0u);
+    }
+
+    TEST(Allocator, testFreeCoalesce)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        size_t offsetA = allocator.alloc(32);
+        size_t offsetB = allocator.alloc(32);
+        size_t offsetC = allocator.alloc(32);
+        allocator.alloc(32);
+        // a, c and then b are freed, they should merge into one 96-byte block
+        allocator.free(offsetA, 32);
+        allocator.free(offsetC, 32);
+        allocator.free(offsetB, 32);
+        EXPECT_EQ(allocator.alloc(96), offsetA);
+    }
+
 } // namespace infini
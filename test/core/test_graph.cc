@@ -1,8 +1,13 @@
+#include "core/calibrator.h"
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/concat.h"
 #include "operators/matmul.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
@@ -37,4 +42,492 @@ namespace infini
         EXPECT_EQ(op->getTransA(), false);
         EXPECT_EQ(op->getTransB(), true);
     }
-}
\ No newline at end of file
+
+    TEST(Graph, FuseElementwise)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({4, 8}, DataType::Float32);
+        Tensor b = g->addTensor({4, 8}, DataType::Float32);
+        Tensor row = g->addTensor({8}, DataType::Float32);
+        Tensor u = g->addTensor({4, 8}, DataType::UInt32);
+        // t1 has two consumers, so both chains start from it
+        auto t1 = g->addOp<AddObj>(x, b, nullptr)->getOutput();
+        auto t2 = g->addOp<ReluObj>(t1, nullptr)->getOutput();
+        auto y1 = g->addOp<ClipObj>(t2, nullptr, 0.f, 6.f)->getOutput();
+        auto t3 = g->addOp<MulObj>(t1, t1, nullptr)->getOutput();
+        auto y2 = g->addOp<SubObj>(t3, x, nullptr)->getOutput();
+        // a row broadcast and other types are left alone
+        auto t4 = g->addOp<AddObj>(y2, row, nullptr)->getOutput();
+        auto y3 = g->addOp<ReluObj>(t4, nullptr)->getOutput();
+        auto t5 = g->addOp<AddObj>(u, u, nullptr)->getOutput();
+        g->addOp<ReluObj>(t5, nullptr);
+        g->optimize();
+
+        std::map<string, int> types;
+        for (auto &op : g->getOperators())
+            types[op->getOpType().toString()]++;
+        EXPECT_EQ(types, (std::map<string, int>{{"Add", 3},
+                                                {"FusedElementwise", 2},
+                                                {"Relu", 2}}));
+        EXPECT_EQ(g->getTensors().size(), 11u);
+        auto fused = as<FusedElementwiseObj>(y1->getSource());
+        EXPECT_EQ(fused->getInputs(), (TensorVec{t1}));
+        ASSERT_EQ(fused->getProgram().size(), 2u);
+        EXPECT_EQ(fused->getProgram()[1].type, OpType::Clip);
+        EXPECT_EQ(fused->getProgram()[1].a, 1);
+        EXPECT_EQ(fused->getProgram()[1].hi, 6.f);
+        fused = as<FusedElementwiseObj>(y2->getSource());
+        EXPECT_EQ(fused->getInputs(), (TensorVec{t1, x}));
+        EXPECT_EQ(t1->getTargets().size(), 2u);
+        EXPECT_EQ(y3->getSource()->getPredecessors().size(), 1u);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, FuseMatmulEpilogue)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({4, 8}, DataType::Float32);
+        Tensor w = g->addTensor({8, 6}, DataType::Float32);
+        Tensor w2 = g->addTensor({8, 6}, DataType::Float32);
+        Tensor w3 = g->addTensor({8, 6}, DataType::Float32);
+        Tensor bias = g->addTensor({6}, DataType::Float32);
+        Tensor full = g->addTensor({4, 6}, DataType::Float32);
+        Tensor s = g->addTensor({1}, DataType::Float32);
+        // bias and clip are folded, the scale is left to the next op
+        auto mm1 = g->addOp<MatmulObj>(x, w, nullptr);
+        auto t1 = g->addOp<AddObj>(mm1->getOutput(), bias, nullptr)->getOutput();
+        auto t2 = g->addOp<ClipObj>(t1, nullptr, 0.f, std::nullopt)->getOutput();
+        auto y1 = g->addOp<MulObj>(t2, s, nullptr)->getOutput();
+        // an Add of a full tensor is not a bias, the Relu is still folded
+        auto mm2 = g->addOp<MatmulObj>(x, w2, nullptr);
+        auto t3 = g->addOp<ReluObj>(mm2->getOutput(), nullptr)->getOutput();
+        auto y2 = g->addOp<AddObj>(t3, full, nullptr)->getOutput();
+        // an output with two consumers stays as it is
+        auto mm3 = g->addOp<MatmulObj>(x, w3, nullptr);
+        auto y3 = g->addOp<AddObj>(mm3->getOutput(), bias, nullptr)->getOutput();
+        auto y4 = g->addOp<ReluObj>(mm3->getOutput(), nullptr)->getOutput();
+        g->optimize();
+
+        std::map<string, int> types;
+        for (auto &op : g->getOperators())
+            types[op->getOpType().toString()]++;
+        EXPECT_EQ(types, (std::map<string, int>{
+                             {"Add", 2}, {"MatMul", 3}, {"Mul", 1}, {"Relu", 1}}));
+        EXPECT_EQ(mm1->getInputs(), (TensorVec{x, w, bias}));
+        EXPECT_EQ(mm1->getAct(), OpType::Clip);
+        EXPECT_EQ(mm1->getActMin(), 0.f);
+        EXPECT_EQ(mm1->getActMax(), std::numeric_limits<float>::max());
+        EXPECT_EQ(mm1->getOutput(), t2);
+        EXPECT_EQ(y1->getSource()->getPredecessors(), (OpVec{mm1}));
+        EXPECT_EQ(mm2->getBias(), nullptr);
+        EXPECT_EQ(mm2->getAct(), OpType::Relu);
+        EXPECT_EQ(y2->getSource()->getInputs(0), mm2->getOutput());
+        EXPECT_EQ(mm3->getBias(), nullptr);
+        EXPECT_EQ(mm3->getAct(), OpType::Unknown);
+        EXPECT_EQ(y3->getSource()->getInputs(0), y4->getSource()->getInputs(0));
+        EXPECT_EQ(bias->getTargets().size(), 2u);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, DataMallocReuse)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({3, 4}, DataType::Float32);
+        auto op1 = g->addOp<TransposeObj>(i, nullptr, Shape{1, 0});
+        auto op2 = g->addOp<TransposeObj>(op1->getOutput(), nullptr, Shape{1, 0});
+        auto op3 = g->addOp<TransposeObj>(op2->getOutput(), nullptr, Shape{1, 0});
+        auto op4 = g->addOp<TransposeObj>(op3->getOutput(), nullptr, Shape{1, 0});
+        g->dataMalloc();
+        auto ptr = [](const Tensor &t) { return t->getRawDataPtr<void *>(); };
+        // t1 is released once op2 has run, so t3 takes over its block
+        EXPECT_EQ(ptr(op1->getOutput()), ptr(op3->getOutput()));
+        // graph input and output stay pinned
+        EXPECT_NE(ptr(i), ptr(op4->getOutput()));
+        EXPECT_NE(ptr(i), ptr(op2->getOutput()));
+        EXPECT_NE(ptr(op3->getOutput()), ptr(op4->getOutput()));
+
+        i->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(op4->getOutput()->equalData(
+            vector<float>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}));
+    }
+
+    TEST(Graph, SharedWeights)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto build = [&](Graph g)
+        {
+            Tensor x = g->addTensor({2, 3}, DataType::Float32);
+            Tensor w = g->addTensor({1, 3}, DataType::Float32);
+            w->setWeight();
+            return g->addOp<MulObj>(x, w, nullptr);
+        };
+        Graph g1 = make_ref<GraphObj>(runtime);
+        auto op1 = build(g1);
+        g1->dataMalloc();
+        op1->getInputs(1)->setData(IncrementalGenerator());
+
+        Graph g2 = make_ref<GraphObj>(runtime);
+        auto op2 = build(g2);
+        g2->shareWeights(g1);
+        g2->dataMalloc();
+        // weights live in g1's persistent arena, activations are private
+        EXPECT_EQ(op2->getInputs(1)->getRawDataPtr<void *>(),
+                  op1->getInputs(1)->getRawDataPtr<void *>());
+        EXPECT_NE(op2->getOutput()->getRawDataPtr<void *>(),
+                  op1->getOutput()->getRawDataPtr<void *>());
+
+        g1 = nullptr;
+        op2->getInputs(0)->setData(OneGenerator());
+        runtime->run(g2);
+        EXPECT_TRUE(op2->getOutput()->equalData(vector<float>{0, 1, 2, 0, 1, 2}));
+    }
+
+    TEST(Graph, Replan)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({32, 3}, DataType::Float32);
+        Tensor w = g->addTensor({1, 3}, DataType::Float32);
+        w->setWeight();
+        auto t = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        auto op = g->addOp<TransposeObj>(t->getOutput(), nullptr, Shape{1, 0});
+        auto add = g->addOp<AddObj>(op->getOutput(), w, nullptr);
+        g->dataMalloc();
+        w->setData(OneGenerator());
+        auto weightPtr = w->getRawDataPtr<void *>();
+        auto arenaPtr = x->getRawDataPtr<void *>();
+        auto peak = g->getMemStats().activation.peak;
+
+        auto check = [&](Shape shape)
+        {
+            x->setShape(shape);
+            g->shape_infer();
+            EXPECT_EQ(add->getOutput()->getDims(), shape);
+            g->dataMalloc();
+            // weights keep their memory and their data
+            EXPECT_EQ(w->getRawDataPtr<void *>(), weightPtr);
+            x->setData(IncrementalGenerator());
+            runtime->run(g);
+            vector<float> ans(x->size());
+            for (size_t i = 0; i < ans.size(); ++i)
+                ans[i] = i + 1;
+            EXPECT_TRUE(add->getOutput()->equalData(ans));
+        };
+        // a smaller batch fits in the existing arena
+        check({16, 3});
+        EXPECT_EQ(x->getRawDataPtr<void *>(), arenaPtr);
+        EXPECT_LT(g->getMemStats().activation.peak, peak);
+        // a larger batch grows it
+        check({64, 3});
+        EXPECT_GT(g->getMemStats().activation.peak, peak);
+    }
+
+    TEST(Graph, Quantize)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({16, 64}, DataType::Float32);
+        Tensor w1 = g->addTensor({64, 96}, DataType::Float32);
+        Tensor w2 = g->addTensor({32, 96}, DataType::Float32);
+        w1->setWeight();
+        w2->setWeight();
+        auto mm1 = g->addOp<MatmulObj>(x, w1, nullptr);
+        auto relu = g->addOp<ReluObj>(mm1->getOutput(), nullptr);
+        auto mm2 = g->addOp<MatmulObj>(relu->getOutput(), w2, nullptr, false, true);
+        auto y = mm2->getOutput();
+        // scattered values in [-1, 1)
+        auto fill = [](const Tensor &t, uint32_t seed)
+        {
+            auto data = t->getRawDataPtr<float *>();
+            for (uint32_t i = 0; i < t->size(); ++i)
+                data[i] = (i * 2654435761u + seed) % 2000 / 1000.f - 1;
+        };
+        g->dataMalloc();
+        fill(x, 0);
+        fill(w1, 1);
+        fill(w2, 2);
+        runtime->run(g);
+        auto out = y->getRawDataPtr<float *>();
+        vector<float> expected(out, out + y->size());
+        auto weightBytes = g->getMemStats().weight.peak;
+
+        Calibrator calibrator;
+        calibrator.collect(g);
+        g->quantize(calibrator);
+        g->dataMalloc();
+        fill(x, 0);
+        runtime->run(g);
+
+        std::map<string, int> types;
+        for (auto &op : g->getOperators())
+            types[op->getOpType().toString()]++;
+        EXPECT_EQ(types, (std::map<string, int>{{"DequantizeLinear", 2},
+                                                {"MatMulInteger", 2},
+                                                {"QuantizeLinear", 2},
+                                                {"Relu", 1}}));
+        // only the int8 weights are left, in a much smaller arena
+        auto weights = g->getWeights();
+        ASSERT_EQ(weights.size(), 2u);
+        for (auto &w : weights)
+            EXPECT_EQ(w->getDType(), DataType::Int8);
+        EXPECT_LT(g->getMemStats().weight.peak, weightBytes / 3);
+
+        out = y->getRawDataPtr<float *>();
+        float maxAbs = 0, maxErr = 0;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            maxAbs = std::max(maxAbs, std::fabs(expected[i]));
+            maxErr = std::max(maxErr, std::fabs(out[i] - expected[i]));
+        }
+        EXPECT_LT(maxErr, 0.02f * maxAbs);
+    }
+
+    TEST(Graph, QuantizeMatmulEpilogue)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({16, 64}, DataType::Float32);
+        Tensor w = g->addTensor({64, 48}, DataType::Float32);
+        Tensor bias = g->addTensor({48}, DataType::Float32);
+        w->setWeight();
+        auto mm = g->addOp<MatmulObj>(x, w, nullptr);
+        auto t = g->addOp<AddObj>(mm->getOutput(), bias, nullptr)->getOutput();
+        auto y = g->addOp<ReluObj>(t, nullptr)->getOutput();
+        g->optimize();
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        auto fill = [](const Tensor &t, uint32_t seed)
+        {
+            auto data = t->getRawDataPtr<float *>();
+            for (uint32_t i = 0; i < t->size(); ++i)
+                data[i] = (i * 2654435761u + seed) % 2000 / 1000.f - 1;
+        };
+        g->dataMalloc();
+        fill(x, 0);
+        fill(w, 1);
+        fill(bias, 2);
+        runtime->run(g);
+        auto out = y->getRawDataPtr<float *>();
+        vector<float> expected(out, out + y->size());
+
+        // the bias and the activation run again after the dequantization
+        Calibrator calibrator;
+        calibrator.collect(g);
+        g->quantize(calibrator);
+        g->dataMalloc();
+        fill(x, 0);
+        fill(bias, 2);
+        runtime->run(g);
+        std::map<string, int> types;
+        for (auto &op : g->getOperators())
+            types[op->getOpType().toString()]++;
+        EXPECT_EQ(types, (std::map<string, int>{{"Add", 1},
+                                                {"DequantizeLinear", 1},
+                                                {"MatMulInteger", 1},
+                                                {"QuantizeLinear", 1},
+                                                {"Relu", 1}}));
+        EXPECT_EQ(y->getSource()->getOpType(), OpType::Relu);
+
+        out = y->getRawDataPtr<float *>();
+        float maxAbs = 0, maxErr = 0;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            maxAbs = std::max(maxAbs, std::fabs(expected[i]));
+            maxErr = std::max(maxErr, std::fabs(out[i] - expected[i]));
+        }
+        EXPECT_LT(maxErr, 0.02f * maxAbs);
+    }
+
+    TEST(Graph, FoldConstants)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        vector<float> wData(24), xData(24);
+        for (size_t i = 0; i < 24; ++i)
+        {
+            wData[i] = i * 0.5f;
+            xData[i] = 1.f - i;
+        }
+        float scale = 3.f;
+        // y[i][j] = x[i][j] + w[j][i] * scale
+        vector<float> expected(24);
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 6; ++j)
+                expected[i * 6 + j] = xData[i * 6 + j] + wData[j * 4 + i] * scale;
+
+        // 常量在 dataMalloc 之前或之后设置，折叠的结果都写入持久内存
+        for (bool allocated : {false, true})
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor x = g->addTensor({4, 6}, DataType::Float32);
+            Tensor w = g->addTensor({6, 4}, DataType::Float32);
+            Tensor s = g->addTensor({1}, DataType::Float32);
+            auto wt = g->addOp<TransposeObj>(w, nullptr, Shape{1, 0})->getOutput();
+            auto ws = g->addOp<MulObj>(wt, s, nullptr)->getOutput();
+            auto y = g->addOp<AddObj>(x, ws, nullptr)->getOutput();
+            if (allocated)
+            {
+                w->setWeight();
+                s->setWeight();
+                g->dataMalloc();
+            }
+            g->setConstant(w, wData.data());
+            g->setConstant(s, &scale);
+            EXPECT_TRUE(w->isConstant());
+            EXPECT_FALSE(x->isConstant());
+
+            g->optimize();
+            ASSERT_EQ(g->getOperators().size(), 1u);
+            auto add = g->getOperators()[0];
+            EXPECT_EQ(add->getOpType(), OpType::Add);
+            EXPECT_EQ(add->getInputs(1), ws);
+            EXPECT_TRUE(ws->isConstant());
+            EXPECT_TRUE(ws->isWeight());
+            EXPECT_EQ(ws->getSource(), nullptr);
+            // 折叠后不再被使用的常量被删除
+            EXPECT_EQ(g->getTensors().size(), 3u);
+            EXPECT_EQ(g->getTensor(w->getFuid()), nullptr);
+            EXPECT_EQ(g->getTensor(wt->getFuid()), nullptr);
+
+            g->dataMalloc();
+            std::copy(xData.begin(), xData.end(), x->getRawDataPtr<float *>());
+            runtime->run(g);
+            EXPECT_TRUE(y->equalData(expected));
+        }
+    }
+
+    TEST(Graph, FoldConstantsKeepsOutputs)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor w = g->addTensor({2, 3}, DataType::Float32);
+        auto wt = g->addOp<TransposeObj>(w, nullptr, Shape{1, 0})->getOutput();
+        vector<float> wData{0, 1, 2, 3, 4, 5};
+        g->setConstant(w, wData.data());
+
+        // 图的输出仍由它的算子产生
+        g->optimize();
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        EXPECT_EQ(wt->getSource()->getOpType(), OpType::Transpose);
+        EXPECT_EQ(g->getOutputs(), TensorVec{wt});
+        g->dataMalloc();
+        runtime->run(g);
+        EXPECT_TRUE(wt->equalData(vector<float>{0, 3, 1, 4, 2, 5}));
+    }
+
+    TEST(Graph, FoldConstantsSharedWeights)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        vector<float> wData{0, 1, 2, 3, 4, 5};
+        auto build = [&](Graph g)
+        {
+            Tensor x = g->addTensor({3, 2}, DataType::Float32);
+            Tensor w = g->addTensor({2, 3}, DataType::Float32);
+            w->setWeight();
+            auto wt = g->addOp<TransposeObj>(w, nullptr, Shape{1, 0})->getOutput();
+            return g->addOp<AddObj>(x, wt, nullptr);
+        };
+        Graph g1 = make_ref<GraphObj>(runtime);
+        auto op1 = build(g1);
+        g1->dataMalloc();
+        Graph g2 = make_ref<GraphObj>(runtime);
+        auto op2 = build(g2);
+        g2->shareWeights(g1);
+        auto w1 = op1->getInputs(1)->getSource()->getInputs(0);
+        auto w2 = op2->getInputs(1)->getSource()->getInputs(0);
+        g1->setConstant(w1, wData.data());
+        g2->setConstant(w2, wData.data());
+
+        // 共享持久内存的图都不折叠，weights 仍然共享
+        for (auto &[g, op, w] : {std::tuple{g1, op1, w1}, std::tuple{g2, op2, w2}})
+        {
+            g->optimize();
+            EXPECT_EQ(g->getOperators().size(), 2u);
+            EXPECT_EQ(op->getInputs(1)->getSource()->getOpType(), OpType::Transpose);
+            EXPECT_EQ(w->getRawDataPtr<void *>(), w1->getRawDataPtr<void *>());
+            g->dataMalloc();
+            EXPECT_EQ(w->getRawDataPtr<void *>(), w1->getRawDataPtr<void *>());
+            op->getInputs(0)->setData(OneGenerator());
+            runtime->run(g);
+            EXPECT_TRUE(op->getOutput()->equalData(vector<float>{1, 4, 2, 5, 3, 6}));
+        }
+
+        // 不再共享之后可以折叠
+        g1 = nullptr;
+        g2->optimize();
+        ASSERT_EQ(g2->getOperators().size(), 1u);
+        EXPECT_EQ(g2->getOperators()[0]->getOpType(), OpType::Add);
+        g2->dataMalloc();
+        op2->getInputs(0)->setData(OneGenerator());
+        runtime->run(g2);
+        EXPECT_TRUE(op2->getOutput()->equalData(vector<float>{1, 4, 2, 5, 3, 6}));
+    }
+
+    TEST(Graph, EliminateCommonSubexpressions)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({2, 3}, DataType::Float32);
+        // 两个 transpose 先并入各自的 matmul，之后两个 matmul 相同
+        auto t1 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0})->getOutput();
+        auto t2 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0})->getOutput();
+        auto m1 = g->addOp<MatmulObj>(x, t1, nullptr)->getOutput();
+        auto m2 = g->addOp<MatmulObj>(x, t2, nullptr)->getOutput();
+        auto y = g->addOp<ConcatObj>(TensorVec{m1, m2}, nullptr, 0)->getOutput();
+        // 属性不同的 cast 保留
+        auto c1 = g->addOp<CastObj>(x, nullptr, CastType::Float2Float16)->getOutput();
+        auto c2 = g->addOp<CastObj>(x, nullptr, CastType::Float2Float16)->getOutput();
+        auto z = g->addOp<ConcatObj>(TensorVec{c1, c2}, nullptr, 1)->getOutput();
+        auto h = g->addOp<CastObj>(x, nullptr, CastType::Float2Int32)->getOutput();
+        g->optimize();
+
+        std::map<string, int> types;
+        for (auto &op : g->getOperators())
+            types[op->getOpType().toString()]++;
+        EXPECT_EQ(types, (std::map<string, int>{{"Cast", 2}, {"Concat", 2}, {"MatMul", 1}}));
+        EXPECT_EQ(y->getSource()->getInputs(0), y->getSource()->getInputs(1));
+        EXPECT_EQ(z->getSource()->getInputs(0), z->getSource()->getInputs(1));
+        EXPECT_EQ(y->getSource()->getPredecessors().size(), 2u);
+        EXPECT_EQ(g->getTensors().size(), 6u);
+
+        g->dataMalloc();
+        vector<float> data{1, 2, 3, -1, 0, 4};
+        std::copy(data.begin(), data.end(), x->getRawDataPtr<float *>());
+        runtime->run(g);
+        EXPECT_TRUE(y->equalData(vector<float>{14, 11, 11, 17, 14, 11, 11, 17}));
+        EXPECT_TRUE(h->equalData(vector<int32_t>{1, 2, 3, -1, 0, 4}));
+    }
+
+    TEST(Graph, MemoryAwareSchedule)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto build = [&](ScheduleMode mode)
+        {
+            // four transpose branches reduced by a chain of adds
+            Graph g = make_ref<GraphObj>(runtime);
+            g->setScheduleMode(mode);
+            Tensor x = g->addTensor({16, 16}, DataType::Float32);
+            TensorVec branches;
+            for (int i = 0; i < 4; ++i)
+            {
+                auto a = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+                auto b = g->addOp<TransposeObj>(a->getOutput(), nullptr, Shape{1, 0});
+                branches.emplace_back(b->getOutput());
+            }
+            Tensor sum = branches[0];
+            for (int i = 1; i < 4; ++i)
+                sum = g->addOp<AddObj>(sum, branches[i], nullptr)->getOutput();
+            g->dataMalloc();
+            x->setData(IncrementalGenerator());
+            runtime->run(g);
+            vector<float> ans(256);
+            for (size_t i = 0; i < ans.size(); ++i)
+                ans[i] = 4 * i;
+            EXPECT_TRUE(sum->equalData(ans));
+            return g->getMemPlan().peak;
+        };
+        EXPECT_LT(build(ScheduleMode::MemoryAware), build(ScheduleMode::Fifo));
+    }
+}
@@ -0,0 +1,181 @@
+#include "core/graph.h"
+#include "core/mem_planner.h"
+#include "core/mem_stats.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    // No two intervals that are live at the same time may share bytes.
+    static bool planIsValid(const vector<MemInterval> &intervals,
+                            const MemPlan &plan)
+    {
+        for (size_t i = 0; i < intervals.size(); ++i)
+        {
+            if (plan.offsets[i] + intervals[i].size > plan.peak)
+                return false;
+            for (size_t j = i + 1; j < intervals.size(); ++j)
+            {
+                if (!intervals[i].overlaps(intervals[j]))
+                    continue;
+                if (plan.offsets[i] < plan.offsets[j] + intervals[j].size &&
+                    plan.offsets[j] < plan.offsets[i] + intervals[i].size)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    TEST(MemoryPlanner, Strategies)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        vector<MemInterval> intervals{
+            {64, 0, 1}, {32, 1, 2}, {64, 2, 3}, {16, 0, 4}, {32, 3, 4}};
+        EXPECT_EQ(MemoryPlanner::lowerBound(intervals), 112u);
+        for (auto mode : {MemPlanMode::Online, MemPlanMode::GreedyBySize,
+                          MemPlanMode::GreedyByBreadth})
+        {
+            Allocator allocator(runtime);
+            auto plan = MemoryPlanner::plan(intervals, mode, allocator);
+            EXPECT_TRUE(planIsValid(intervals, plan));
+            EXPECT_EQ(plan.lowerBound, 112u);
+            EXPECT_GE(plan.peak, plan.lowerBound);
+        }
+        Allocator allocator(runtime);
+        auto plan = MemoryPlanner::plan(intervals, MemPlanMode::GreedyBySize,
+                                        allocator);
+        EXPECT_EQ(plan.peak, 112u);
+    }
+
+    TEST(MemoryPlanner, GraphOffline)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        for (auto mode : {MemPlanMode::GreedyBySize, MemPlanMode::GreedyByBreadth})
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            g->setMemPlanMode(mode);
+            auto i0 = g->addTensor({2, 3}, DataType::Float32);
+            auto i1 = g->addTensor({2, 3}, DataType::Float32);
+            auto add = g->addOp<AddObj>(i0, i1, nullptr);
+            auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+            auto mul = g->addOp<MulObj>(relu->getOutput(), i1, nullptr);
+            g->dataMalloc();
+            EXPECT_GE(g->getMemPlan().peak, g->getMemPlan().lowerBound);
+
+            i0->setData(IncrementalGenerator());
+            i1->setData(OneGenerator());
+            runtime->run(g);
+            EXPECT_TRUE(mul->getOutput()->equalData(
+                vector<float>{1, 2, 3, 4, 5, 6}));
+        }
+    }
+
+    TEST(MemoryPlanner, Inplace)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto i0 = g->addTensor({2, 3}, DataType::Float32);
+        auto i1 = g->addTensor({1, 3}, DataType::Float32);
+        auto sub = g->addOp<SubObj>(i0, i1, nullptr);
+        auto relu = g->addOp<ReluObj>(sub->getOutput(), nullptr);
+        auto clip = g->addOp<ClipObj>(relu->getOutput(), nullptr, 1.0f, 3.0f);
+        auto add = g->addOp<AddObj>(clip->getOutput(), i1, nullptr);
+        g->dataMalloc();
+        auto ptr = [](const Tensor &t) { return t->getRawDataPtr<void *>(); };
+        // relu, clip and add all run in the buffer produced by sub
+        EXPECT_EQ(ptr(sub->getOutput()), ptr(relu->getOutput()));
+        EXPECT_EQ(ptr(sub->getOutput()), ptr(clip->getOutput()));
+        EXPECT_EQ(ptr(sub->getOutput()), ptr(add->getOutput()));
+        // graph inputs are never overwritten
+        EXPECT_NE(ptr(i0), ptr(sub->getOutput()));
+
+        i0->setData(IncrementalGenerator());
+        i1->setData(OneGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(add->getOutput()->equalData(vector<float>{2, 2, 2, 3, 4, 4}));
+    }
+
+    TEST(MemoryPlanner, ZeroCopyConcat)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        auto ptr = [](const Tensor &t) { return t->getRawDataPtr<float *>(); };
+        {
+            // slabs along dim 1 are contiguous because dim 0 is 1
+            Graph g = make_ref<GraphObj>(runtime);
+            auto i0 = g->addTensor({1, 2, 3}, DataType::Float32);
+            auto i1 = g->addTensor({1, 1, 3}, DataType::Float32);
+            auto relu0 = g->addOp<ReluObj>(i0, nullptr);
+            auto relu1 = g->addOp<ReluObj>(i1, nullptr);
+            auto concat = g->addOp<ConcatObj>(
+                TensorVec{relu0->getOutput(), relu1->getOutput()}, nullptr, 1);
+            g->dataMalloc();
+            EXPECT_EQ(ptr(relu0->getOutput()), ptr(concat->getOutput()));
+            EXPECT_EQ(ptr(relu1->getOutput()), ptr(concat->getOutput()) + 6);
+
+            i0->setData(IncrementalGenerator());
+            i1->setData(OneGenerator());
+            runtime->run(g);
+            EXPECT_TRUE(concat->getOutput()->equalData(
+                vector<float>{0, 1, 2, 3, 4, 5, 1, 1, 1}));
+        }
+        {
+            // slabs along dim 1 are interleaved, the inputs are copied
+            Graph g = make_ref<GraphObj>(runtime);
+            auto i0 = g->addTensor({2, 2}, DataType::Float32);
+            auto i1 = g->addTensor({2, 1}, DataType::Float32);
+            auto relu0 = g->addOp<ReluObj>(i0, nullptr);
+            auto relu1 = g->addOp<ReluObj>(i1, nullptr);
+            auto concat = g->addOp<ConcatObj>(
+                TensorVec{relu0->getOutput(), relu1->getOutput()}, nullptr, 1);
+            g->dataMalloc();
+            EXPECT_NE(ptr(relu0->getOutput()), ptr(concat->getOutput()));
+
+            i0->setData(IncrementalGenerator());
+            i1->setData(OneGenerator());
+            runtime->run(g);
+            EXPECT_TRUE(concat->getOutput()->equalData(
+                vector<float>{0, 1, 1, 2, 3, 1}));
+        }
+    }
+
+    TEST(MemoryPlanner, Stats)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({4, 16}, DataType::Float32);
+        auto w = g->addTensor({1, 16}, DataType::Float32);
+        w->setWeight();
+        auto t0 = g->addOp<TransposeObj>(x, nullptr, Shape{1, 0});
+        auto t1 = g->addOp<TransposeObj>(t0->getOutput(), nullptr, Shape{1, 0});
+        auto add = g->addOp<AddObj>(t1->getOutput(), w, nullptr);
+        g->dataMalloc();
+
+        auto stats = g->getMemStats();
+        ASSERT_EQ(stats.tensors.size(), g->getTensors().size());
+        ASSERT_EQ(stats.timeline.size(), 3u);
+        EXPECT_EQ(stats.timeline[0].type, OpType::Transpose);
+        // x and t0 at step 0, x, t0 and t1 at step 1, then add runs in place
+        EXPECT_EQ(stats.timeline[0].liveBytes, 2 * 256u);
+        EXPECT_EQ(stats.timeline[1].liveBytes, 3 * 256u);
+        EXPECT_EQ(stats.timeline[2].liveBytes, 2 * 256u);
+        for (auto &t : stats.tensors)
+            EXPECT_EQ(t.weight, t.fuid == w->getFuid());
+        EXPECT_EQ(stats.weight.peak, 64u);
+        EXPECT_LE(stats.activation.fragmentation, 1.);
+
+        std::ostringstream csv, json;
+        exportMemStats(csv, stats, MemStatsFormat::Csv);
+        exportMemStats(json, stats, MemStatsFormat::Json);
+        EXPECT_EQ(csv.str(), "step,guid,type,live_bytes\n"
+                             "0," + std::to_string(t0->getGuid()) + ",Transpose,512\n"
+                             "1," + std::to_string(t1->getGuid()) + ",Transpose,768\n"
+                             "2," + std::to_string(add->getGuid()) + ",Add,512\n");
+        EXPECT_NE(json.str().find("\"timeline\""), string::npos);
+    }
+
+} // namespace infini
@@ -0,0 +1,164 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include "utils/float16.h"
+
+#include "test.h"
+
+#include <cmath>
+#include <limits>
+
+namespace infini {
+
+// Casts `data` (of dtype `dtype`) on the CPU and returns the output elements.
+template <typename To, typename From>
+static vector<To> runCast(const vector<From> &data, DataType dtype,
+                          CastType type) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({int(data.size())}, dtype);
+    auto op = g->addOp<CastObj>(input, nullptr, type);
+    g->dataMalloc();
+    input->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(data.begin(), size, reinterpret_cast<From *>(ptr));
+    });
+    runtime->run(g);
+    auto out = op->getOutput()->getRawDataPtr<To *>();
+    return vector<To>(out, out + data.size());
+}
+
+// Repeats the values so that both the SIMD body and the tail are covered.
+template <typename T> static vector<T> spread(const vector<T> &values) {
+    vector<T> ret;
+    for (int i = 0; i < 37; ++i)
+        ret.insert(ret.end(), values.begin(), values.end());
+    return ret;
+}
+
+static uint32_t bitsOf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+TEST(Cast, NativeCpuFloat16) {
+    // known encodings: rounding, overflow, subnormals, signed zero and NaN
+    const float inf = std::numeric_limits<float>::infinity();
+    vector<float> values{1.f,   -2.f,     65504.f,    65520.f,    65519.f,
+                         inf,   0x1p-24f, 0x1p-25f,   -0.f,       0.1f,
+                         1e-6f, 0x1.002p0f, 0x1.006p0f, NAN};
+    vector<uint16_t> bits{0x3c00, 0xc000, 0x7bff, 0x7c00, 0x7bff,
+                          0x7c00, 0x0001, 0x0000, 0x8000, 0x2e66,
+                          0x0011, 0x3c00, 0x3c02, 0x7e00};
+    for (size_t i = 0; i < values.size(); ++i)
+        EXPECT_EQ(floatToFp16(values[i]), bits[i]) << values[i];
+
+    // the F16C paths agree with the scalar helpers on every half value
+    vector<uint16_t> halves(1 << 16);
+    for (size_t i = 0; i < halves.size(); ++i)
+        halves[i] = i;
+    auto floats =
+        runCast<float>(halves, DataType::Float16, CastType::Float162Float);
+    for (size_t i = 0; i < halves.size(); ++i)
+        EXPECT_EQ(bitsOf(floats[i]), bitsOf(fp16ToFloat(halves[i]))) << i;
+    auto back =
+        runCast<uint16_t>(floats, DataType::Float32, CastType::Float2Float16);
+    for (size_t i = 0; i < halves.size(); ++i) {
+        bool nan = (i & 0x7c00) == 0x7c00 && (i & 0x3ff);
+        EXPECT_EQ(back[i], nan ? i | 0x200 : i) << i;
+    }
+
+    // and on values between halves
+    vector<float> between;
+    for (int i = -20000; i < 20000; ++i)
+        between.push_back(i * 3.7f + 0.31f * (i % 7));
+    between.insert(between.end(), values.begin(), values.end());
+    auto rounded =
+        runCast<uint16_t>(between, DataType::Float32, CastType::Float2Float16);
+    for (size_t i = 0; i < between.size(); ++i)
+        EXPECT_EQ(rounded[i], floatToFp16(between[i])) << between[i];
+}
+
+TEST(Cast, NativeCpuBFloat16) {
+    vector<float> values{1.f, -2.f, 1.00390625f, 1.01171875f, 3e38f, NAN,
+                         0.f, 1e-40f};
+    vector<uint16_t> bits{0x3f80, 0xc000, 0x3f80, 0x3f82,
+                          0x7f62, 0x7fc0, 0x0000, 0x0001};
+    auto data = spread(values);
+    auto out =
+        runCast<uint16_t>(data, DataType::Float32, CastType::Float2BFloat16);
+    for (size_t i = 0; i < data.size(); ++i)
+        EXPECT_EQ(out[i], bits[i % bits.size()]) << data[i];
+
+    auto back =
+        runCast<float>(out, DataType::BFloat16, CastType::BFloat162Float);
+    for (size_t i = 0; i < out.size(); ++i)
+        EXPECT_EQ(bitsOf(back[i]), uint32_t(out[i]) << 16);
+}
+
+TEST(Cast, NativeCpuSaturate) {
+    const float inf = std::numeric_limits<float>::infinity();
+    auto in8 = spread<float>(
+        {-1e9f, -128.5f, -3.7f, 0.f, 2.9f, 126.9f, 127.5f, 300.f, NAN, inf});
+    vector<int8_t> ref8{-128, -128, -3, 0, 2, 126, 127, 127, 0, 127};
+    auto out8 = runCast<int8_t>(in8, DataType::Float32, CastType::Float2Int8);
+    for (size_t i = 0; i < in8.size(); ++i)
+        EXPECT_EQ(out8[i], ref8[i % ref8.size()]) << in8[i];
+
+    const int32_t max32 = std::numeric_limits<int32_t>::max();
+    const int32_t min32 = std::numeric_limits<int32_t>::min();
+    auto in32 =
+        spread<float>({3e9f, -3e9f, 0x1p31f, -0x1p31f, 2147483520.f, NAN,
+                       -2.5f, -inf, inf, 1e6f});
+    vector<int32_t> ref32{max32, min32, max32, min32, 2147483520,
+                          0,     -2,    min32, max32, 1000000};
+    auto out32 =
+        runCast<int32_t>(in32, DataType::Float32, CastType::Float2Int32);
+    for (size_t i = 0; i < in32.size(); ++i)
+        EXPECT_EQ(out32[i], ref32[i % ref32.size()]) << in32[i];
+
+    const int64_t max64 = std::numeric_limits<int64_t>::max();
+    auto in64 = spread<float>({1e19f, -1e19f, NAN, -7.9f, 0x1p40f});
+    vector<int64_t> ref64{max64, std::numeric_limits<int64_t>::min(), 0, -7,
+                          int64_t(1) << 40};
+    auto out64 =
+        runCast<int64_t>(in64, DataType::Float32, CastType::Float2Int64);
+    for (size_t i = 0; i < in64.size(); ++i)
+        EXPECT_EQ(out64[i], ref64[i % ref64.size()]) << in64[i];
+}
+
+TEST(Cast, NativeCpuIntegers) {
+    auto in = spread<int32_t>({0, 1, -1, 127, 128, -129, 40000, -70000});
+    auto to8 = runCast<int8_t>(in, DataType::Int32, CastType::Int322Int8);
+    auto to64 = runCast<int64_t>(in, DataType::Int32, CastType::Int322Int64);
+    auto toF = runCast<float>(in, DataType::Int32, CastType::Int322Float);
+    for (size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(to8[i], int8_t(in[i]));
+        EXPECT_EQ(to64[i], in[i]);
+        EXPECT_EQ(toF[i], float(in[i]));
+    }
+
+    auto bytes = spread<uint8_t>({0, 1, 127, 128, 255});
+    auto fromU8 = runCast<int32_t>(bytes, DataType::UInt8,
+                                   CastType::Uint82Int32);
+    for (size_t i = 0; i < bytes.size(); ++i)
+        EXPECT_EQ(fromU8[i], bytes[i]);
+
+    auto wide = spread<int64_t>({-1, int64_t(1) << 40, 5});
+    auto toU32 =
+        runCast<uint32_t>(wide, DataType::Int64, CastType::Int642Uint32);
+    for (size_t i = 0; i < wide.size(); ++i)
+        EXPECT_EQ(toU32[i], uint32_t(wide[i]));
+}
+
+TEST(Cast, NativeCpuLarge) {
+    vector<float> data(100003);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = float(i) - 50000.5f;
+    auto out =
+        runCast<int32_t>(data, DataType::Float32, CastType::Float2Int32);
+    for (size_t i = 0; i < data.size(); ++i)
+        ASSERT_EQ(out[i], int32_t(data[i])) << i;
+}
+
+} // namespace infini
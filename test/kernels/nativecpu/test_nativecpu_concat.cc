@@ -25,4 +25,71 @@ TEST(Concat, NativeCpu) {
                       6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+TEST(Concat, NativeCpuLarge) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // (input shapes, dim): many short runs, a few long runs split across
+    // tasks, and an empty input
+    vector<pair<vector<Shape>, int>> cases{
+        {{{20000, 3}, {20000, 1}}, 1},
+        {{{2, 30000}, {2, 50000}, {2, 7}}, 1},
+        {{{40000}, {0}, {30000}}, 0},
+        {{{3, 4, 5000}, {3, 2, 5000}}, 1},
+    };
+    for (auto &[shapes, dim] : cases) {
+        Graph g = make_ref<GraphObj>(runtime);
+        TensorVec inputs;
+        for (auto &shape : shapes)
+            inputs.push_back(g->addTensor(shape, DataType::Float32));
+        auto op = g->addOp<ConcatObj>(inputs, nullptr, dim);
+        g->dataMalloc();
+        // element j of input i holds i * 1e6 + j
+        for (size_t i = 0; i < inputs.size(); ++i)
+            inputs[i]->setData([i](void *ptr, size_t size, DataType) {
+                for (size_t j = 0; j < size; ++j)
+                    reinterpret_cast<float *>(ptr)[j] = i * 1e6 + j;
+            });
+        runtime->run(g);
+
+        auto outDim = op->getOutput()->getDims();
+        size_t inner = 1;
+        for (size_t d = dim + 1; d < outDim.size(); ++d)
+            inner *= outDim[d];
+        vector<float> ref;
+        size_t outer = op->getOutput()->size() / (outDim[dim] * inner);
+        for (size_t o = 0; o < outer; ++o)
+            for (size_t i = 0; i < shapes.size(); ++i) {
+                size_t len = shapes[i][dim] * inner;
+                for (size_t j = o * len; j < (o + 1) * len; ++j)
+                    ref.push_back(i * 1e6 + j);
+            }
+        EXPECT_TRUE(op->getOutput()->equalData(ref));
+    }
+}
+
+TEST(Concat, NativeCpuHalf) {
+    // 16-bit elements are only moved, element j of input i holds i * 100 + j
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (auto dtype : {DataType::Float16, DataType::BFloat16}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto t1 = g->addTensor({2, 3, 5}, dtype);
+        auto t2 = g->addTensor({2, 1, 5}, dtype);
+        auto op = g->addOp<ConcatObj>(TensorVec{t1, t2}, nullptr, 1);
+        g->dataMalloc();
+        for (auto [t, base] : {pair{t1, 0}, pair{t2, 100}})
+            t->setData([base = base](void *ptr, size_t size, DataType) {
+                for (size_t j = 0; j < size; ++j)
+                    reinterpret_cast<uint16_t *>(ptr)[j] = base + j;
+            });
+        runtime->run(g);
+
+        auto out = op->getOutput()->getRawDataPtr<uint16_t *>();
+        for (size_t o = 0; o < 2; ++o) {
+            for (size_t j = 0; j < 15; ++j)
+                EXPECT_EQ(out[o * 20 + j], o * 15 + j);
+            for (size_t j = 0; j < 5; ++j)
+                EXPECT_EQ(out[o * 20 + 15 + j], 100 + o * 5 + j);
+        }
+    }
+}
+
 } // namespace infini
@@ -1,6 +1,7 @@
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/element_wise.h"
+#include "utils/float16.h"
 
 #include "test.h"
 
@@ -41,4 +42,80 @@ TEST(ElementWise, NativeCpu) {
         Shape{2, 1, 1}, ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+TEST(ElementWise, NativeCpuBroadcastPatterns) {
+    // same shape, scalar, column, row and middle-dim broadcast
+    testElementWiseNativeCpu<AddObj>(IncrementalGenerator(),
+                                     IncrementalGenerator(), Shape{2, 3},
+                                     Shape{2, 3},
+                                     ExpectOutput{0, 2, 4, 6, 8, 10});
+    testElementWiseNativeCpu<AddObj>(IncrementalGenerator(), OneGenerator(),
+                                     Shape{2, 3}, Shape{1},
+                                     ExpectOutput{1, 2, 3, 4, 5, 6});
+    testElementWiseNativeCpu<AddObj>(IncrementalGenerator(),
+                                     IncrementalGenerator(), Shape{2, 3},
+                                     Shape{2, 1},
+                                     ExpectOutput{0, 1, 2, 4, 5, 6});
+    testElementWiseNativeCpu<AddObj>(IncrementalGenerator(),
+                                     IncrementalGenerator(), Shape{2, 3},
+                                     Shape{3}, ExpectOutput{0, 2, 4, 3, 5, 7});
+    testElementWiseNativeCpu<AddObj>(
+        IncrementalGenerator(), IncrementalGenerator(), Shape{2, 2, 2},
+        Shape{2, 1, 2}, ExpectOutput{0, 2, 2, 4, 6, 8, 8, 10});
+    testElementWiseNativeCpu<SubObj>(OneGenerator(), IncrementalGenerator(),
+                                     Shape{1}, Shape{2, 2},
+                                     ExpectOutput{1, 0, -1, -2});
+}
+
+TEST(ElementWise, NativeCpuLarge) {
+    // several tasks per row and a tail shorter than a SIMD register
+    Shape shape{2, 3, 20001};
+    size_t n = 2 * 3 * 20001;
+    ExpectOutput ans(n);
+    for (size_t i = 0; i < n; ++i)
+        ans[i] = i + i % 20001;
+    testElementWiseNativeCpu<AddObj>(IncrementalGenerator(),
+                                     IncrementalGenerator(), shape,
+                                     Shape{20001}, ans);
+}
+
+TEST(ElementWise, NativeCpuHalf) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // same shape, row broadcast and scalar, each with a long row
+    vector<Shape> shapesB{{3, 1000}, {1000}, {1}};
+    for (auto dtype : {DataType::Float16, DataType::BFloat16}) {
+        bool bf16 = dtype == DataType::BFloat16;
+        auto round = [&](float v) {
+            return bf16 ? bf16ToFloat(floatToBf16(v))
+                        : fp16ToFloat(floatToFp16(v));
+        };
+        for (auto &shapeB : shapesB) {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto a = g->addTensor({3, 1000}, dtype);
+            auto b = g->addTensor(shapeB, dtype);
+            auto op = g->addOp<DivObj>(a, b, nullptr);
+            g->dataMalloc();
+            // element i holds i / 7 + 1 rounded to the storage type
+            auto fill = [&](void *ptr, size_t size, DataType) {
+                for (size_t i = 0; i < size; ++i)
+                    reinterpret_cast<uint16_t *>(ptr)[i] =
+                        bf16 ? floatToBf16(i / 7.f + 1)
+                             : floatToFp16(i / 7.f + 1);
+            };
+            a->setData(fill);
+            b->setData(fill);
+            runtime->run(g);
+
+            auto out = op->getOutput()->getRawDataPtr<uint16_t *>();
+            size_t sizeB = b->size();
+            for (size_t i = 0; i < a->size(); ++i) {
+                float ans = round(round(i / 7.f + 1) /
+                                  round(i % sizeB / 7.f + 1));
+                ASSERT_EQ(bf16 ? bf16ToFloat(out[i]) : fp16ToFloat(out[i]),
+                          ans)
+                    << i;
+            }
+        }
+    }
+}
+
 } // namespace infini
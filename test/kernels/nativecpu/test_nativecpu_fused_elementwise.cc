@@ -0,0 +1,94 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace infini {
+
+// Deterministic values in [-2, 2), some of them exactly 0.
+static void fill(const Tensor &t, uint32_t seed) {
+    auto data = t->getRawDataPtr<float *>();
+    for (uint32_t i = 0; i < t->size(); ++i)
+        data[i] = ((i * 2654435761u + seed) % 41) / 10.f - 2;
+}
+
+TEST(FusedElementwise, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // sizes with and without a SIMD tail, over several chunks and tasks
+    for (Shape shape : {Shape{1}, Shape{3, 7}, Shape{2, 600}, Shape{5, 9001}}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor(shape, DataType::Float32);
+        auto b = g->addTensor(shape, DataType::Float32);
+        auto s = g->addTensor({1}, DataType::Float32);
+        // clip(relu((a + b) * s) - a / b, -, 1.5)
+        auto add = g->addOp<AddObj>(a, b, nullptr);
+        auto mul = g->addOp<MulObj>(add->getOutput(), s, nullptr);
+        auto relu = g->addOp<ReluObj>(mul->getOutput(), nullptr);
+        auto div = g->addOp<DivObj>(a, b, nullptr);
+        auto sub = g->addOp<SubObj>(relu->getOutput(), div->getOutput(),
+                                    nullptr);
+        auto clip = g->addOp<ClipObj>(sub->getOutput(), nullptr, std::nullopt,
+                                      1.5f);
+        auto y = clip->getOutput();
+        g->dataMalloc();
+        fill(a, 1);
+        fill(b, 2);
+        fill(s, 3);
+        runtime->run(g);
+        auto out = y->getRawDataPtr<float *>();
+        vector<float> expected(out, out + y->size());
+
+        g->optimize();
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        EXPECT_EQ(g->getOperators()[0]->getOpType(), OpType::FusedElementwise);
+        g->dataMalloc();
+        fill(a, 1);
+        fill(b, 2);
+        fill(s, 3);
+        runtime->run(g);
+        // same operations in the same order, NaN and inf included
+        out = y->getRawDataPtr<float *>();
+        EXPECT_EQ(std::memcmp(out, expected.data(), y->getBytes()), 0)
+            << vecToString(shape);
+    }
+}
+
+TEST(FusedElementwise, NativeCpuInplace) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1000}, DataType::Float32);
+    auto s = g->addTensor({1}, DataType::Float32);
+    auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    // x * x + relu(x), with the product written over the relu output
+    auto sq = g->addOp<FusedElementwiseObj>(
+        TensorVec{t, x}, nullptr,
+        vector<FusedInstr>{{OpType::Mul, 1, 1, 0.f, 0.f},
+                           {OpType::Add, 2, 0, 0.f, 0.f}});
+    auto y = g->addOp<FusedElementwiseObj>(
+                  TensorVec{sq->getOutput(), s}, nullptr,
+                  vector<FusedInstr>{{OpType::Clip, 0, 0, -1.f, 2.f},
+                                     {OpType::Mul, 2, 1, 0.f, 0.f}})
+                 ->getOutput();
+    g->dataMalloc();
+    EXPECT_EQ(y->getRawDataPtr<void *>(),
+              sq->getOutput()->getRawDataPtr<void *>());
+    fill(x, 5);
+    fill(s, 6);
+    runtime->run(g);
+    auto in = x->getRawDataPtr<float *>();
+    float scale = *s->getRawDataPtr<float *>();
+    vector<float> expected;
+    for (size_t i = 0; i < x->size(); ++i)
+        expected.emplace_back(
+            std::clamp(in[i] * in[i] + std::max(in[i], 0.f), -1.f, 2.f) *
+            scale);
+    EXPECT_TRUE(y->equalData(expected));
+}
+
+} // namespace infini
@@ -0,0 +1,295 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "utils/float16.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Small integers keep every partial sum exact in float32.
+static void smallIntGenerator(void *data, size_t size, DataType dataType) {
+    auto ptr = reinterpret_cast<float *>(data);
+    for (size_t i = 0; i < size; ++i)
+        ptr[i] = float(int(i * 7 % 11) - 5);
+}
+
+static void copyIn(const Tensor &t, const vector<float> &data) {
+    t->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(data.begin(), size, reinterpret_cast<float *>(ptr));
+    });
+}
+
+// Plain triple loop over the broadcast batch, read through Tensor::getDims.
+static vector<float> referenceMatmul(const vector<float> &a, const Shape &dimA,
+                                     const vector<float> &b, const Shape &dimB,
+                                     const Shape &dimC, bool transA,
+                                     bool transB) {
+    int rankA = dimA.size(), rankB = dimB.size(), rankC = dimC.size();
+    int m = dimC[rankC - 2], n = dimC[rankC - 1];
+    int k = transA ? dimA[rankA - 2] : dimA[rankA - 1];
+    size_t batch = 1;
+    for (int i = 0; i < rankC - 2; ++i)
+        batch *= dimC[i];
+    vector<float> c(batch * m * n);
+    for (size_t bt = 0; bt < batch; ++bt) {
+        // right-aligned broadcast of the batch index
+        size_t offA = 0, offB = 0, strideA = m * k, strideB = k * n;
+        size_t rest = bt;
+        for (int i = rankC - 3; i >= 0; --i) {
+            size_t idx = rest % dimC[i];
+            rest /= dimC[i];
+            int ia = i - (rankC - rankA), ib = i - (rankC - rankB);
+            if (ia >= 0) {
+                offA += (dimA[ia] == 1 ? 0 : idx) * strideA;
+                strideA *= dimA[ia];
+            }
+            if (ib >= 0) {
+                offB += (dimB[ib] == 1 ? 0 : idx) * strideB;
+                strideB *= dimB[ib];
+            }
+        }
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double sum = 0;
+                for (int p = 0; p < k; ++p)
+                    sum += a[offA + (transA ? p * m + i : i * k + p)] *
+                           b[offB + (transB ? j * k + p : p * n + j)];
+                c[bt * m * n + i * n + j] = sum;
+            }
+    }
+    return c;
+}
+
+static void testMatmulNativeCpu(const Shape &shapeA, const Shape &shapeB,
+                                bool transA, bool transB) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, DataType::Float32);
+    auto b = g->addTensor(shapeB, DataType::Float32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr, transA, transB);
+    g->dataMalloc();
+    a->setData(smallIntGenerator);
+    b->setData(smallIntGenerator);
+    runtime->run(g);
+
+    vector<float> dataA(a->size()), dataB(b->size());
+    smallIntGenerator(dataA.data(), dataA.size(), DataType::Float32);
+    smallIntGenerator(dataB.data(), dataB.size(), DataType::Float32);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        referenceMatmul(dataA, shapeA, dataB, shapeB,
+                        op->getOutput()->getDims(), transA, transB)));
+}
+
+TEST(Matmul, NativeCpu) {
+    testMatmulNativeCpu({2, 3}, {3, 4}, false, false);
+    // edge tiles in every direction and more than one KC block
+    testMatmulNativeCpu({37, 300}, {300, 29}, false, false);
+    testMatmulNativeCpu({300, 37}, {300, 29}, true, false);
+    testMatmulNativeCpu({37, 300}, {29, 300}, false, true);
+    testMatmulNativeCpu({300, 37}, {29, 300}, true, true);
+    // several MC blocks with parallel tiles
+    testMatmulNativeCpu({200, 64}, {64, 100}, false, false);
+}
+
+TEST(Matmul, NativeCpuGemv) {
+    // m == 1 reads B by rows (transB) or by columns
+    testMatmulNativeCpu({1, 300}, {300, 77}, false, false);
+    testMatmulNativeCpu({300, 1}, {77, 300}, true, true);
+    // n == 1 reads A by rows or by columns (transA)
+    testMatmulNativeCpu({77, 300}, {300, 1}, false, false);
+    testMatmulNativeCpu({300, 77}, {1, 300}, true, true);
+    testMatmulNativeCpu({1, 5}, {5, 1}, false, false);
+    testMatmulNativeCpu({3, 1, 64}, {64, 500}, false, false);
+}
+
+TEST(Matmul, NativeCpuBatchedSmall) {
+    // attention-like 64x64 tiles with a broadcast operand
+    testMatmulNativeCpu({2, 4, 64, 64}, {1, 4, 64, 64}, false, false);
+    testMatmulNativeCpu({2, 4, 64, 64}, {2, 1, 64, 64}, false, true);
+    // sizes that leave row and column tails in every tile shape
+    testMatmulNativeCpu({8, 13, 29}, {8, 29, 45}, false, false);
+    testMatmulNativeCpu({8, 29, 13}, {45, 29}, true, true);
+}
+
+TEST(Matmul, NativeCpuPrepacked) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (bool transB : {false, true}) {
+        Shape shapeA{2, 37, 300};
+        Shape shapeB = transB ? Shape{29, 300} : Shape{300, 29};
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor(shapeA, DataType::Float32);
+        auto b = g->addTensor(shapeB, DataType::Float32);
+        b->setWeight();
+        auto op = g->addOp<MatmulObj>(a, b, nullptr, false, transB);
+        g->dataMalloc();
+        ASSERT_NE(op->getPrepacked(), nullptr);
+        // B (aligned to 64 bytes) followed by its 2 panels of 16 columns
+        EXPECT_EQ(g->getMemStats().weight.peak, 34816u + 32 * 300 * 4u);
+
+        vector<float> dataA(a->size()), dataB(b->size());
+        smallIntGenerator(dataA.data(), dataA.size(), DataType::Float32);
+        smallIntGenerator(dataB.data(), dataB.size(), DataType::Float32);
+        copyIn(a, dataA);
+        copyIn(b, dataB);
+        runtime->run(g);
+        EXPECT_TRUE(op->getOutput()->equalData(referenceMatmul(
+            dataA, shapeA, dataB, shapeB, op->getOutput()->getDims(), false,
+            transB)));
+
+        // new weights are only seen after packing them again
+        for (auto &v : dataB)
+            v = -v;
+        copyIn(b, dataB);
+        g->prepack();
+        runtime->run(g);
+        EXPECT_TRUE(op->getOutput()->equalData(referenceMatmul(
+            dataA, shapeA, dataB, shapeB, op->getOutput()->getDims(), false,
+            transB)));
+    }
+}
+
+TEST(Matmul, NativeCpuPrepackedReshaped) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 37, 300}, DataType::Float32);
+    auto b = g->addTensor({300, 29}, DataType::Float32);
+    b->setWeight();
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    ASSERT_NE(op->getPrepacked(), nullptr);
+    runtime->run(g);
+
+    // the same bytes of B read as another shape: the buffer packed for the
+    // old one is left unused
+    Shape shapeA{2, 37, 150}, shapeB{150, 58};
+    a->setShape(shapeA);
+    b->setShape(shapeB);
+    g->shape_infer();
+    g->dataMalloc();
+    EXPECT_EQ(op->getPrepacked(), nullptr);
+    vector<float> dataA(a->size()), dataB(b->size());
+    smallIntGenerator(dataA.data(), dataA.size(), DataType::Float32);
+    smallIntGenerator(dataB.data(), dataB.size(), DataType::Float32);
+    copyIn(a, dataA);
+    copyIn(b, dataB);
+    g->prepack();
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(referenceMatmul(
+        dataA, shapeA, dataB, shapeB, op->getOutput()->getDims(), false,
+        false)));
+}
+
+TEST(Matmul, NativeCpuHalf) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // blocked, also over several k and n blocks, prepacked blocked, both
+    // GEMV layouts over several widened blocks and batched small matrices
+    vector<pair<Shape, Shape>> shapes{{{150, 20}, {20, 30}},
+                                      {{100, 600}, {600, 2100}},
+                                      {{2, 37, 300}, {300, 29}},
+                                      {{1, 64}, {64, 40}},
+                                      {{1, 3000}, {3000, 40}},
+                                      {{70, 2000}, {2000, 1}},
+                                      {{3, 5, 6}, {6, 7}}};
+    for (auto dtype : {DataType::Float16, DataType::BFloat16}) {
+        bool bf16 = dtype == DataType::BFloat16;
+        for (auto &[shapeA, shapeB] : shapes) {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto a = g->addTensor(shapeA, dtype);
+            auto b = g->addTensor(shapeB, dtype);
+            if (shapeA.size() == 3 && shapeA[2] == 300)
+                b->setWeight();
+            auto op = g->addOp<MatmulObj>(a, b, nullptr);
+            g->dataMalloc();
+            EXPECT_EQ(op->getPrepacked() != nullptr, b->isWeight());
+
+            vector<float> dataA(a->size()), dataB(b->size());
+            smallIntGenerator(dataA.data(), dataA.size(), dtype);
+            smallIntGenerator(dataB.data(), dataB.size(), dtype);
+            for (auto [t, data] : {pair{a, &dataA}, pair{b, &dataB}})
+                t->setData([&](void *ptr, size_t size, DataType) {
+                    floatToHalfOf(bf16)(reinterpret_cast<uint16_t *>(ptr),
+                                        data->data(), size);
+                });
+            runtime->run(g);
+
+            // the float sums are exact, rounding them once gives the output
+            auto out = op->getOutput();
+            auto ref = referenceMatmul(dataA, shapeA, dataB, shapeB,
+                                       out->getDims(), false, false);
+            vector<float> ans(out->size());
+            halfToFloatOf(bf16)(ans.data(), out->getRawDataPtr<uint16_t *>(),
+                                ans.size());
+            for (size_t i = 0; i < ref.size(); ++i)
+                ASSERT_EQ(ans[i], bf16 ? bf16ToFloat(floatToBf16(ref[i]))
+                                       : fp16ToFloat(floatToFp16(ref[i])))
+                    << i;
+        }
+    }
+}
+
+TEST(Matmul, NativeCpuBroadcast) {
+    testMatmulNativeCpu({2, 3, 5, 7}, {3, 7, 4}, false, false);
+    testMatmulNativeCpu({2, 1, 7, 5}, {1, 3, 4, 7}, true, true);
+    testMatmulNativeCpu({4, 5, 7}, {7, 6}, false, false);
+}
+
+TEST(Matmul, NativeCpuEpilogue) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    struct Case {
+        Shape shapeA, shapeB;
+        bool transA, transB, weight;
+    };
+    // blocked with edge tiles, prepacked, both GEMV layouts with m == 1 and
+    // n == 1, batched small matrices and k == 0
+    vector<Case> cases{{{37, 300}, {300, 29}, false, false, false},
+                       {{2, 37, 300}, {29, 300}, false, true, true},
+                       {{1, 300}, {300, 77}, false, false, false},
+                       {{300, 1}, {77, 300}, true, true, false},
+                       {{77, 300}, {300, 1}, false, false, false},
+                       {{300, 77}, {1, 300}, true, true, false},
+                       {{8, 13, 29}, {8, 29, 45}, false, false, false},
+                       {{4, 0}, {0, 20}, false, false, false}};
+    for (auto &tc : cases)
+        for (OpType act : {OpType::Unknown, OpType::Relu, OpType::Clip}) {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto a = g->addTensor(tc.shapeA, DataType::Float32);
+            auto b = g->addTensor(tc.shapeB, DataType::Float32);
+            if (tc.weight)
+                b->setWeight();
+            auto op = g->addOp<MatmulObj>(a, b, nullptr, tc.transA, tc.transB);
+            int n = op->getN();
+            auto bias = g->addTensor({1, n}, DataType::Float32);
+            auto y = g->addOp<AddObj>(bias, op->getOutput(), nullptr)
+                         ->getOutput();
+            if (act == OpType::Relu)
+                y = g->addOp<ReluObj>(y, nullptr)->getOutput();
+            else if (act == OpType::Clip)
+                y = g->addOp<ClipObj>(y, nullptr, -20.f, 30.f)->getOutput();
+            g->dataMalloc();
+            a->setData(smallIntGenerator);
+            b->setData(smallIntGenerator);
+            bias->setData(IncrementalGenerator());
+            runtime->run(g);
+            auto out = y->getRawDataPtr<float *>();
+            vector<float> expected(out, out + y->size());
+
+            g->optimize();
+            ASSERT_EQ(g->getOperators().size(), 1u);
+            EXPECT_EQ(op->getBias(), bias);
+            EXPECT_EQ(op->getAct(), act);
+            EXPECT_EQ(op->getOutput(), y);
+            g->dataMalloc();
+            a->setData(smallIntGenerator);
+            b->setData(smallIntGenerator);
+            bias->setData(IncrementalGenerator());
+            runtime->run(g);
+            EXPECT_TRUE(y->equalData(expected))
+                << vecToString(tc.shapeA) << " x " << vecToString(tc.shapeB)
+                << " " << act.toString();
+        }
+}
+
+} // namespace infini
@@ -0,0 +1,227 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/quantize.h"
+
+#include "test.h"
+
+#include <cmath>
+
+namespace infini {
+
+template <typename T> static void copyIn(const Tensor &t, const vector<T> &data) {
+    t->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(data.begin(), size, reinterpret_cast<T *>(ptr));
+    });
+}
+
+template <typename T> static vector<T> copyOut(const Tensor &t) {
+    auto ptr = t->getRawDataPtr<T *>();
+    return vector<T>(ptr, ptr + t->size());
+}
+
+// Deterministic values in [lo, hi].
+template <typename T> static vector<T> pattern(size_t size, int lo, int hi) {
+    vector<T> ret(size);
+    for (size_t i = 0; i < size; ++i)
+        ret[i] = T(lo + int(i * 37 % 101 * (hi - lo) / 100));
+    return ret;
+}
+
+TEST(Quantize, NativeCpuPerTensor) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // rounding half to even, saturation and the zero point, repeated so that
+    // both the SIMD body and the tail run
+    vector<float> values{0.f, 0.25f, 0.75f, 1.25f, -0.25f, -0.75f,
+                         100.f, -100.f, 63.4f, -64.5f, 1.f / 3};
+    vector<int8_t> expected{3, 3, 5, 5, 3, 1, 127, -128, 127, -126, 4};
+    vector<float> data;
+    for (int i = 0; i < 41; ++i)
+        data.insert(data.end(), values.begin(), values.end());
+
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({int(data.size())}, DataType::Float32);
+    auto quant =
+        g->addOp<QuantizeLinearObj>(x, nullptr, QuantParams{{0.5f}, {3}});
+    auto dequant = g->addOp<DequantizeLinearObj>(quant->getOutput(), nullptr);
+    g->dataMalloc();
+    copyIn(x, data);
+    runtime->run(g);
+
+    auto q = copyOut<int8_t>(quant->getOutput());
+    auto y = copyOut<float>(dequant->getOutput());
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(q[i], expected[i % expected.size()]) << data[i];
+        EXPECT_EQ(y[i], (q[i] - 3) * 0.5f);
+    }
+}
+
+TEST(Quantize, NativeCpuPerChannel) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // channels on the middle dim, with runs shorter and longer than a task
+    for (Shape shape : {Shape{3, 4, 5}, Shape{2, 3, 40000}}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(shape, DataType::Float32);
+        int channels = shape[1];
+        QuantParams params{{}, {}, 1};
+        for (int c = 0; c < channels; ++c) {
+            params.scales.push_back(0.1f * (c + 1));
+            params.zeroPoints.push_back(c * 10 - 10);
+        }
+        auto quant = g->addOp<QuantizeLinearObj>(x, nullptr, params);
+        auto dequant =
+            g->addOp<DequantizeLinearObj>(quant->getOutput(), nullptr);
+        g->dataMalloc();
+        auto data = pattern<float>(x->size(), -20, 20);
+        copyIn(x, data);
+        runtime->run(g);
+
+        auto q = copyOut<int8_t>(quant->getOutput());
+        auto y = copyOut<float>(dequant->getOutput());
+        size_t inner = shape[2];
+        for (size_t i = 0; i < data.size(); ++i) {
+            int c = i / inner % channels;
+            float v = std::nearbyint(data[i] / params.scales[c]) +
+                      params.zeroPoints[c];
+            ASSERT_EQ(q[i], int8_t(std::clamp(v, -128.f, 127.f))) << i;
+            ASSERT_EQ(y[i], (q[i] - params.zeroPoints[c]) * params.scales[c]);
+        }
+    }
+}
+
+TEST(Quantize, NativeCpuDequantizeInt32) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto q = g->addTensor({2, 3}, DataType::Int32);
+    q->setQuantParams({{0.5f, 2.f, 0.25f}, {0, 0, 4}, 1});
+    auto dequant = g->addOp<DequantizeLinearObj>(q, nullptr);
+    g->dataMalloc();
+    copyIn<int32_t>(q, {1000000, -3, 4, 7, 8, 0});
+    runtime->run(g);
+    EXPECT_TRUE(dequant->getOutput()->equalData(
+        vector<float>{500000.f, -6.f, 0.f, 3.5f, 16.f, -1.f}));
+}
+
+// Exact int32 reference of (A - za) * (B - zb[j]) over a broadcast batch.
+static vector<int32_t> referenceMatmulInteger(
+    const vector<int8_t> &a, const Shape &dimA, int32_t za,
+    const vector<int8_t> &b, const Shape &dimB, const vector<int32_t> &zb,
+    const Shape &dimC, bool transA, bool transB) {
+    int rankA = dimA.size(), rankB = dimB.size(), rankC = dimC.size();
+    int m = dimC[rankC - 2], n = dimC[rankC - 1];
+    int k = transA ? dimA[rankA - 2] : dimA[rankA - 1];
+    size_t batch = 1;
+    for (int i = 0; i < rankC - 2; ++i)
+        batch *= dimC[i];
+    vector<int32_t> c(batch * m * n);
+    for (size_t bt = 0; bt < batch; ++bt) {
+        size_t offA = 0, offB = 0, strideA = m * k, strideB = k * n;
+        size_t rest = bt;
+        for (int i = rankC - 3; i >= 0; --i) {
+            size_t idx = rest % dimC[i];
+            rest /= dimC[i];
+            int ia = i - (rankC - rankA), ib = i - (rankC - rankB);
+            if (ia >= 0) {
+                offA += (dimA[ia] == 1 ? 0 : idx) * strideA;
+                strideA *= dimA[ia];
+            }
+            if (ib >= 0) {
+                offB += (dimB[ib] == 1 ? 0 : idx) * strideB;
+                strideB *= dimB[ib];
+            }
+        }
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                int32_t sum = 0;
+                for (int p = 0; p < k; ++p)
+                    sum += (a[offA + (transA ? p * m + i : i * k + p)] - za) *
+                           (b[offB + (transB ? j * k + p : p * n + j)] - zb[j]);
+                c[bt * m * n + i * n + j] = sum;
+            }
+    }
+    return c;
+}
+
+TEST(MatmulInteger, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    struct Case {
+        Shape dimA, dimB;
+        bool transA, transB, weight, perChannel;
+    };
+    vector<Case> cases{
+        {{5, 7}, {7, 3}, false, false, false, false},
+        {{1, 1}, {1, 1}, false, false, false, false},
+        {{37, 130}, {130, 45}, false, false, true, true},
+        {{130, 37}, {45, 130}, true, true, true, true},
+        {{2, 3, 17, 9}, {1, 3, 9, 20}, false, false, false, true},
+        {{4, 6, 33}, {33, 18}, false, false, true, false},
+        {{3, 64, 64}, {3, 64, 64}, false, true, false, false},
+        {{8, 0}, {0, 5}, false, false, false, false},
+    };
+    for (auto &tc : cases) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto A = g->addTensor(tc.dimA, DataType::Int8);
+        auto B = g->addTensor(tc.dimB, DataType::Int8);
+        if (tc.weight)
+            B->setWeight();
+        auto op =
+            g->addOp<MatmulIntegerObj>(A, B, nullptr, tc.transA, tc.transB);
+        int n = op->getN(), rankB = tc.dimB.size();
+        int32_t za = -7;
+        vector<int32_t> zb(n, 3);
+        A->setQuantParams({{0.1f}, {za}});
+        if (tc.perChannel && n > 1) {
+            QuantParams params{vector<float>(n, 1.f), {},
+                               tc.transB ? rankB - 2 : rankB - 1};
+            for (int j = 0; j < n; ++j)
+                params.zeroPoints.push_back(zb[j] = j % 5 - 2);
+            B->setQuantParams(params);
+        } else {
+            B->setQuantParams({{1.f}, {zb[0]}});
+        }
+        g->dataMalloc();
+        auto a = pattern<int8_t>(A->size(), -128, 127);
+        auto b = pattern<int8_t>(B->size(), -128, 127);
+        for (size_t i = 0; i < b.size(); i += 3)
+            b[i] = int8_t(127 - i % 256);
+        copyIn(A, a);
+        copyIn(B, b);
+        runtime->run(g);
+        auto C = op->getOutput();
+        EXPECT_EQ(copyOut<int32_t>(C),
+                  referenceMatmulInteger(a, tc.dimA, za, b, tc.dimB, zb,
+                                         C->getDims(), tc.transA, tc.transB))
+            << vecToString(tc.dimA) << " x " << vecToString(tc.dimB);
+    }
+}
+
+TEST(MatmulInteger, NativeCpuPrepackedReshaped) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto A = g->addTensor({37, 130}, DataType::Int8);
+    auto B = g->addTensor({130, 45}, DataType::Int8);
+    B->setWeight();
+    auto op = g->addOp<MatmulIntegerObj>(A, B, nullptr);
+    g->dataMalloc();
+    ASSERT_NE(op->getPrepacked(), nullptr);
+
+    // the buffer packed for the old shape of B is left unused
+    Shape dimA{37, 65}, dimB{65, 90};
+    A->setShape(dimA);
+    B->setShape(dimB);
+    g->shape_infer();
+    g->dataMalloc();
+    EXPECT_EQ(op->getPrepacked(), nullptr);
+    auto a = pattern<int8_t>(A->size(), -128, 127);
+    auto b = pattern<int8_t>(B->size(), -128, 127);
+    copyIn(A, a);
+    copyIn(B, b);
+    g->prepack();
+    runtime->run(g);
+    auto C = op->getOutput();
+    EXPECT_EQ(copyOut<int32_t>(C),
+              referenceMatmulInteger(a, dimA, 0, b, dimB, vector<int32_t>(90, 0),
+                                     C->getDims(), false, false));
+}
+
+} // namespace infini
@@ -24,4 +24,69 @@ TEST(Transpose, NativeCpu) {
                                                           8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+// Naive per-element transpose of IncrementalGenerator data.
+static vector<float> referenceTranspose(const Shape &dims, const Shape &perm) {
+    int rank = dims.size();
+    size_t size = 1;
+    for (auto d : dims)
+        size *= d;
+    vector<float> ret(size);
+    Shape pos(rank, 0);
+    for (size_t i = 0; i < size; ++i) {
+        size_t rest = i, outIdx = 0;
+        for (int d = rank - 1; d >= 0; --d) {
+            pos[d] = rest % dims[d];
+            rest /= dims[d];
+        }
+        for (int j = 0; j < rank; ++j)
+            outIdx = outIdx * dims[perm[j]] + pos[perm[j]];
+        ret[outIdx] = i;
+    }
+    return ret;
+}
+
+TEST(Transpose, NativeCpuTiled) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    vector<pair<Shape, Shape>> cases{
+        {{37, 45}, {1, 0}},             // 2D, partial tiles
+        {{3, 64, 40}, {0, 2, 1}},       // last two axes
+        {{2, 3, 33, 17}, {2, 0, 3, 1}}, // general
+        {{4, 5, 6}, {1, 0, 2}},         // innermost dim unchanged
+        {{1, 5, 1, 7}, {3, 2, 1, 0}},   // size-1 dims dropped
+        {{2, 3, 4, 5}, {2, 3, 0, 1}},   // merged to a 2D transpose
+    };
+    for (auto &[shape, permute] : cases) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor(shape, DataType::Float32);
+        auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+        g->dataMalloc();
+        input->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(
+            op->getOutput(0)->equalData(referenceTranspose(shape, permute)));
+    }
+}
+
+TEST(Transpose, NativeCpuHalf) {
+    // 16-bit elements are only moved, element i holds the bits of i
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Shape shape{3, 37, 45}, permute{2, 0, 1};
+    for (auto dtype : {DataType::Float16, DataType::BFloat16}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input = g->addTensor(shape, dtype);
+        auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+        g->dataMalloc();
+        input->setData([](void *ptr, size_t size, DataType) {
+            for (size_t i = 0; i < size; ++i)
+                reinterpret_cast<uint16_t *>(ptr)[i] = i;
+        });
+        runtime->run(g);
+
+        auto ref = referenceTranspose(shape, permute);
+        auto out = op->getOutput()->getRawDataPtr<uint16_t *>();
+        for (size_t i = 0; i < ref.size(); ++i)
+            ASSERT_EQ(out[i], uint16_t(ref[i])) << i;
+    }
+}
+
 } // namespace infini
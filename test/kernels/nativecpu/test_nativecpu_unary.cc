@@ -0,0 +1,110 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include "utils/float16.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Centers the incremental values on 0 so both branches are taken.
+static void centeredGenerator(void *data, size_t size, DataType dataType) {
+    auto ptr = reinterpret_cast<float *>(data);
+    for (size_t i = 0; i < size; ++i)
+        ptr[i] = float(i) - float(size / 2);
+}
+
+TEST(Unary, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // more than one task, plus a tail shorter than a SIMD register
+    for (Shape shape : {Shape{2, 3}, Shape{3, 20001}}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto i0 = g->addTensor(shape, DataType::Float32);
+        auto i1 = g->addTensor(shape, DataType::Float32);
+        auto relu = g->addOp<ReluObj>(i0, nullptr);
+        auto clip = g->addOp<ClipObj>(i1, nullptr, -2.f, 2.f);
+        g->dataMalloc();
+        i0->setData(centeredGenerator);
+        i1->setData(centeredGenerator);
+        runtime->run(g);
+
+        size_t n = i0->size();
+        vector<float> reluAns(n), clipAns(n);
+        centeredGenerator(reluAns.data(), n, DataType::Float32);
+        centeredGenerator(clipAns.data(), n, DataType::Float32);
+        for (size_t i = 0; i < n; ++i) {
+            reluAns[i] = std::max(0.f, reluAns[i]);
+            clipAns[i] = std::min(2.f, std::max(-2.f, clipAns[i]));
+        }
+        EXPECT_TRUE(relu->getOutput()->equalData(reluAns));
+        EXPECT_TRUE(clip->getOutput()->equalData(clipAns));
+    }
+}
+
+TEST(Unary, NativeCpuClipUInt32) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // bounds outside of the type's range clip nothing on their side
+    struct Case {
+        float min, max;
+        vector<uint32_t> expected;
+    };
+    vector<uint32_t> data{0, 3, 7, 100, 4294967295u};
+    vector<Case> cases{
+        {-1.f, 5.f, {0, 3, 5, 5, 5}},
+        {2.f, 1e10f, {2, 3, 7, 100, 4294967295u}},
+        {-1e10f, 4294967296.f, data},
+    };
+    for (auto &tc : cases) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto i0 = g->addTensor({5}, DataType::UInt32);
+        auto clip = g->addOp<ClipObj>(i0, nullptr, tc.min, tc.max);
+        g->dataMalloc();
+        i0->setData([&](void *ptr, size_t size, DataType) {
+            std::copy_n(data.begin(), size, reinterpret_cast<uint32_t *>(ptr));
+        });
+        runtime->run(g);
+        EXPECT_TRUE(clip->getOutput()->equalData(tc.expected))
+            << tc.min << ", " << tc.max;
+    }
+}
+
+TEST(Unary, NativeCpuHalf) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (auto dtype : {DataType::Float16, DataType::BFloat16}) {
+        bool bf16 = dtype == DataType::BFloat16;
+        Graph g = make_ref<GraphObj>(runtime);
+        auto i0 = g->addTensor({3, 1001}, dtype);
+        auto i1 = g->addTensor({3, 1001}, dtype);
+        auto relu = g->addOp<ReluObj>(i0, nullptr);
+        auto clip = g->addOp<ClipObj>(i1, nullptr, -2.f, std::nullopt);
+        g->dataMalloc();
+        size_t n = i0->size();
+        vector<float> data(n);
+        centeredGenerator(data.data(), n, DataType::Float32);
+        for (auto &v : data)
+            v /= 256;
+        auto fill = [&](void *ptr, size_t size, DataType) {
+            floatToHalfOf(bf16)(reinterpret_cast<uint16_t *>(ptr),
+                                data.data(), size);
+        };
+        i0->setData(fill);
+        i1->setData(fill);
+        runtime->run(g);
+
+        vector<float> reluOut(n), clipOut(n);
+        halfToFloatOf(bf16)(reluOut.data(),
+                            relu->getOutput()->getRawDataPtr<uint16_t *>(), n);
+        halfToFloatOf(bf16)(clipOut.data(),
+                            clip->getOutput()->getRawDataPtr<uint16_t *>(), n);
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t h;
+            floatToHalfOf(bf16)(&h, &data[i], 1);
+            float x;
+            halfToFloatOf(bf16)(&x, &h, 1);
+            ASSERT_EQ(reluOut[i], std::max(0.f, x)) << i;
+            ASSERT_EQ(clipOut[i], std::max(-2.f, x)) << i;
+        }
+    }
+}
+
+} // namespace infini
@@ -20,4 +20,19 @@ namespace infini {
         EXPECT_EQ(op->getOutDType(), (DataType::Float32));
     }
 
+    TEST(Clip, OpAttrVector)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i0 = g->addTensor({2, 3}, DataType::Float32);
+        auto op = g->addOp<ClipObj>(i0, nullptr, 0.f, 6.f);
+        EXPECT_EQ(op->getOpAttrVector(),
+                  g->addOp<ClipObj>(i0, nullptr, 0.f, 6.f)->getOpAttrVector());
+        // an absent bound differs from any value
+        EXPECT_NE(op->getOpAttrVector(),
+                  g->addOp<ClipObj>(i0, nullptr, 0.f, 5.f)->getOpAttrVector());
+        EXPECT_NE(g->addOp<ClipObj>(i0, nullptr, 0.f, std::nullopt)->getOpAttrVector(),
+                  g->addOp<ClipObj>(i0, nullptr, 0.f, 0.f)->getOpAttrVector());
+    }
+
 } // namespace infini
@@ -0,0 +1,46 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/fused_element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(FusedElementwise, ShapeInference) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor s = g->addTensor({1}, DataType::Float32);
+        // relu(a * s) + a
+        vector<FusedInstr> program{{OpType::Mul, 0, 1, 0.f, 0.f},
+                                   {OpType::Relu, 2, -1, 0.f, 0.f},
+                                   {OpType::Add, 3, 0, 0.f, 0.f}};
+        auto op = g->addOp<FusedElementwiseObj>(TensorVec{s, a}, nullptr,
+                                                program);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(op->getOutDType(), DataType::Float32);
+        EXPECT_EQ(op->getProgram()[1].b, 2);
+    }
+    {
+        // only single elements are broadcast
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        Tensor b = g->addTensor({3}, DataType::Float32);
+        vector<FusedInstr> program{{OpType::Add, 0, 1, 0.f, 0.f}};
+        EXPECT_THROW(g->addOp<FusedElementwiseObj>(TensorVec{a, b}, nullptr,
+                                                   program),
+                     Exception);
+    }
+    {
+        // steps only read earlier slots
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor a = g->addTensor({2, 3}, DataType::Float32);
+        vector<FusedInstr> program{{OpType::Add, 0, 1, 0.f, 0.f}};
+        EXPECT_THROW(
+            g->addOp<FusedElementwiseObj>(TensorVec{a}, nullptr, program),
+            Exception);
+    }
+}
+
+} // namespace infini
@@ -0,0 +1,52 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/quantize.h"
+
+#include "test.h"
+
+namespace infini
+{
+    TEST(Quantize, ShapeInference)
+    {
+        auto runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor(Shape{2, 3, 4}, DataType::Float32);
+        auto quant = g->addOp<QuantizeLinearObj>(
+            x, nullptr, QuantParams{{0.5f, 0.25f, 1.f}, {0, 1, -2}, -2});
+        auto q = quant->getOutput();
+        EXPECT_EQ(q->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(q->getDType(), DataType::Int8);
+        // the output carries the parameters, with the axis made positive
+        EXPECT_TRUE(q->isQuantized());
+        EXPECT_EQ(q->getQuantParams().axis, 1);
+        EXPECT_EQ(q->getQuantParams().zeroPoints, (vector<int32_t>{0, 1, -2}));
+
+        auto dequant = g->addOp<DequantizeLinearObj>(q, nullptr);
+        EXPECT_EQ(dequant->getOutput()->getDims(), (Shape{2, 3, 4}));
+        EXPECT_EQ(dequant->getOutput()->getDType(), DataType::Float32);
+
+        // per-channel scales must match the channel dim
+        EXPECT_THROW(g->addOp<QuantizeLinearObj>(
+                         x, nullptr, QuantParams{{1.f, 2.f}, {0, 0}, 2}),
+                     Exception);
+    }
+
+    TEST(MatmulInteger, ShapeInference)
+    {
+        auto runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto A = g->addTensor(Shape{2, 3, 5, 4}, DataType::Int8);
+        auto B = g->addTensor(Shape{1, 3, 2, 5}, DataType::Int8);
+        auto matmul = g->addOp<MatmulIntegerObj>(A, B, nullptr, true, true);
+        auto C = matmul->getOutput();
+        EXPECT_EQ(C->getDims(), (Shape{2, 3, 4, 2}));
+        EXPECT_EQ(C->getDType(), DataType::Int32);
+        EXPECT_EQ(matmul->getOpType(), OpType::MatMulInteger);
+
+        auto F = g->addTensor(Shape{5, 2}, DataType::Float32);
+        EXPECT_THROW(g->addOp<MatmulIntegerObj>(A, F, nullptr, true), Exception);
+    }
+
+}; // namespace infini